@@ -616,10 +616,10 @@ F     b7  f07 f17 | D1  MUX  7  |         f27 f37     E0F A07
 
 
 #define ADC_ERROR_DISABLED                          (-32767) /* ADC is disabled. Please enable it or use analogReadEnh(), or don't take analog readings. */
-#define ADC_ERROR_BUSY                              (-32766) /* Not currently generated */
+#define ADC_ERROR_BUSY                              (-32766) /* A conversion is under way, or one started by analogReadStart() hasn't been collected */
 #define ADC_ERROR_BAD_PIN_OR_CHANNEL                (-32765) /* Pin is not a valid ADC pin */
 #define ADC_ENH_ERROR_BAD_PIN_OR_CHANNEL       (-2100000000) /* Pin, or Positive pin for differential, is not a valid ADC pin */
-#define ADC_ENH_ERROR_BUSY                     (-2100000002) /* Not currently generated */
+#define ADC_ENH_ERROR_BUSY                     (-2100000002) /* A conversion is under way, or one started by analogReadEnhStart() hasn't been collected */
 #define ADC_ENH_ERROR_RES_TOO_LOW              (-2100000003) /* Requested resolution is less than 8 bits */
 #define ADC_ENH_ERROR_RES_TOO_HIGH             (-2100000004) /* Requested resolution exceeds what can be generated using builtin accumulation and decimation */
 #define ADC_DIFF_ERROR_BAD_NEG_PIN             (-2100000005) /* See datasheet or Analog reference, not all pins can be negative. */
@@ -868,6 +868,23 @@ void restart_millis();                       // After having stopped millis eith
 void set_millis(uint32_t newmillis);         // Sets the millisecond timer to the specified number of milliseconds. DO NOT CALL with a number lower than the current millis count if you have any timeouts ongoing.
                                              // they may expire instantly.
 void nudge_millis(uint16_t nudgemillis);     // Sets the millisecond timer forward by the specified number of milliseconds.
+void wake_at_micros(uint32_t us);            // With MILLIS_TICKLESS, makes sure the millis timer interrupts (waking the chip from sleep) by the time micros() reaches us. Otherwise does nothing.
+void idle_until_micros(uint32_t us);         // Idle sleep until micros() reaches us, or any interrupt wakes the chip.
+
+/* Software timers - see wiring_timers.c. The softTimer_t is yours to allocate, and must stay put while the timer is pending.
+ * It must start out zeroed, which globals and statics always do. Don't touch the members. */
+typedef struct softTimer_struct {
+  struct softTimer_struct  *next;
+  struct softTimer_struct **pprev;           // NULL when not pending.
+  uint32_t                  expires;
+  uint32_t                  period;
+  voidFuncPtr               callback;
+} softTimer_t;
+void timerOnce(softTimer_t *timer, uint32_t ms, voidFuncPtr callback);   // call callback once, ms milliseconds from now. Restarts the timer if it's already pending.
+void timerEvery(softTimer_t *timer, uint32_t ms, voidFuncPtr callback);  // call callback every ms milliseconds, starting ms milliseconds from now.
+void timerCancel(softTimer_t *timer);                                    // Stop the timer. Harmless if it's not pending.
+void runTimers();                                                        // Run any callbacks that are due. Called after every loop() and while in delay().
+static inline bool timerPending(softTimer_t *timer) {return timer->pprev != NULL;}
 
 uint8_t _getCurrentMillisTimer();
 
@@ -952,6 +969,28 @@ uint8_t          PWMoutputTopin(uint8_t timer, uint8_t channel);
 
 int32_t           analogReadEnh(uint8_t pin,                uint8_t res,  uint8_t gain);
 int32_t          analogReadDiff(uint8_t pos,  uint8_t neg,  uint8_t res,  uint8_t gain);
+int16_t         analogReadStart(uint8_t pin);
+int32_t      analogReadEnhStart(uint8_t pin,                uint8_t res,  uint8_t gain);
+int32_t     analogReadDiffStart(uint8_t pos,  uint8_t neg,  uint8_t res,  uint8_t gain);
+bool            analogReadReady();
+bool          analogReadPending();
+int16_t        analogReadResult();
+int32_t     analogReadEnhResult();
+
+/* ADC window watchdog - see wiring_analog_window.c. The callback is called from the ADC interrupt each time the reading
+ * enters (inside = true) or leaves (inside = false) the window between low and high, which are in analogRead() units. */
+typedef void (*analogWindowFuncPtr)(bool inside, int16_t value);
+#define ADC_WINDOW_FREERUN  (0) // convert continuously
+#define ADC_WINDOW_EVENT    (1) // convert each time an event is received on the ADC start user (event::user::adc0_start)
+bool    analogWindowStart(uint8_t pin, int16_t low, int16_t high, analogWindowFuncPtr callback, uint8_t trigger);
+void     analogWindowStop();
+bool   analogWindowInside();
+
+/* ADC result correction - see the ADCCalibration library. If set, every result from analogRead(), analogReadEnh() and
+ * analogReadDiff() (but not error codes) is passed through it before it is returned. bits is the full scale of the value
+ * (for raw accumulation, as many bits as the sum can have), and differential is true for analogReadDiff(). */
+typedef int32_t (*analogCorrectionFuncPtr)(int32_t value, uint8_t bits, bool differential);
+void    analogSetCorrection(analogCorrectionFuncPtr correction);
 int16_t        analogClockSpeed(int16_t frequency, uint8_t options);
 bool       analogReadResolution(uint8_t res);
 bool       analogSampleDuration(uint8_t dur);
@@ -980,6 +1019,8 @@ uint8_t getAnalogSampleDuration();
   //uint8_t digitalPinToTimerNow(uint8_t p);=
   int32_t analogReadEnh( uint8_t pin,              uint8_t res = ADC_NATIVE_RESOLUTION, uint8_t gain = 0);
   int32_t analogReadDiff(uint8_t pos, uint8_t neg, uint8_t res = ADC_NATIVE_RESOLUTION, uint8_t gain = 0);
+  int32_t analogReadEnhStart( uint8_t pin,              uint8_t res = ADC_NATIVE_RESOLUTION, uint8_t gain = 0);
+  int32_t analogReadDiffStart(uint8_t pos, uint8_t neg, uint8_t res = ADC_NATIVE_RESOLUTION, uint8_t gain = 0);
   int16_t analogClockSpeed(int16_t frequency = 0,  uint8_t options = 0);
 #endif
 
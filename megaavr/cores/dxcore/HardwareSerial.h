@@ -115,42 +115,108 @@
 #if !defined(SERIAL_RX_BUFFER_SIZE)   // could be overridden by boards.txt
   #if   (INTERNAL_SRAM_SIZE <  512)  // 128/256b RAM
     #define SERIAL_RX_BUFFER_SIZE 16
-    // current tx buffer position = SerialClass + txtail + 37
   #elif (INTERNAL_SRAM_SIZE < 1024)  // 512b RAM
     #define SERIAL_RX_BUFFER_SIZE 32
-    // current tx buffer position = SerialClass + txtail + 53
   #else
     #define SERIAL_RX_BUFFER_SIZE 64  // 1k+ RAM
-    // current tx buffer position = SerialClass + txtail + 85
-    // rx buffer position always = SerialClass + rxhead + 21
   #endif
 #endif
+/* Per-port buffer sizes. Each defaults to the global size, but can be overridden the same way (for example,
+ * -DSERIAL2_RX_BUFFER_SIZE=512 -DSERIAL3_TX_BUFFER_SIZE=16). These set the size of the buffers that are
+ * statically allocated in UARTn.cpp and used unless you pass your own to begin().
+ */
+#if !defined(SERIAL0_RX_BUFFER_SIZE)
+  #define SERIAL0_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL0_TX_BUFFER_SIZE)
+  #define SERIAL0_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL1_RX_BUFFER_SIZE)
+  #define SERIAL1_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL1_TX_BUFFER_SIZE)
+  #define SERIAL1_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL2_RX_BUFFER_SIZE)
+  #define SERIAL2_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL2_TX_BUFFER_SIZE)
+  #define SERIAL2_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL3_RX_BUFFER_SIZE)
+  #define SERIAL3_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL3_TX_BUFFER_SIZE)
+  #define SERIAL3_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL4_RX_BUFFER_SIZE)
+  #define SERIAL4_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL4_TX_BUFFER_SIZE)
+  #define SERIAL4_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL5_RX_BUFFER_SIZE)
+  #define SERIAL5_RX_BUFFER_SIZE SERIAL_RX_BUFFER_SIZE
+#endif
+#if !defined(SERIAL5_TX_BUFFER_SIZE)
+  #define SERIAL5_TX_BUFFER_SIZE SERIAL_TX_BUFFER_SIZE
+#endif
+
 /* Use INTERNAL_SRAM_SIZE instead of RAMEND - RAMSTART, which is vulnerable to
- * a fencepost error. */
-#if (SERIAL_TX_BUFFER_SIZE > 256)
+ * a fencepost error.
+ * The index type is shared by all ports, so it has to be 16-bit if any port has a buffer over 256 bytes. The compile-time sizes
+ * are checked here; if you will pass larger buffers to begin() at runtime, define SERIAL_RX_INDEX_16BIT and/or SERIAL_TX_INDEX_16BIT
+ * yourself. When the sizes make it 16-bit, only ports configured over 256 lose the asm ISRs (see below), and only those ports can
+ * be given a buffer over 256 bytes at runtime. When you define it, every port uses the C ISRs, so any of them can.
+ */
+#if defined(SERIAL_TX_INDEX_16BIT)
+  #define SERIAL_TX_INDEX_USER
+#endif
+#if defined(SERIAL_RX_INDEX_16BIT)
+  #define SERIAL_RX_INDEX_USER
+#endif
+#if (SERIAL0_TX_BUFFER_SIZE > 256 || SERIAL1_TX_BUFFER_SIZE > 256 || SERIAL2_TX_BUFFER_SIZE > 256 || \
+     SERIAL3_TX_BUFFER_SIZE > 256 || SERIAL4_TX_BUFFER_SIZE > 256 || SERIAL5_TX_BUFFER_SIZE > 256) && !defined(SERIAL_TX_INDEX_16BIT)
+  #define SERIAL_TX_INDEX_16BIT
+#endif
+#if (SERIAL0_RX_BUFFER_SIZE > 256 || SERIAL1_RX_BUFFER_SIZE > 256 || SERIAL2_RX_BUFFER_SIZE > 256 || \
+     SERIAL3_RX_BUFFER_SIZE > 256 || SERIAL4_RX_BUFFER_SIZE > 256 || SERIAL5_RX_BUFFER_SIZE > 256) && !defined(SERIAL_RX_INDEX_16BIT)
+  #define SERIAL_RX_INDEX_16BIT
+#endif
+#if defined(SERIAL_TX_INDEX_16BIT)
   typedef uint16_t tx_buffer_index_t;
+  #define SERIAL_TX_BUFFER_MAX 32768
 #else
   typedef uint8_t  tx_buffer_index_t;
+  #define SERIAL_TX_BUFFER_MAX 256
 #endif
-// I am not convinced > 256b is safe for the RX buffer....
-#if (SERIAL_RX_BUFFER_SIZE > 256)
+#if defined(SERIAL_RX_INDEX_16BIT)
   typedef uint16_t rx_buffer_index_t;
+  #define SERIAL_RX_BUFFER_MAX 32768
 #else
   typedef uint8_t  rx_buffer_index_t;
+  #define SERIAL_RX_BUFFER_MAX 256
 #endif
 // As noted above, forcing the sizes to be a power of two saves a small
 // amount of flash, and there's no compelling reason to NOT have them be
-// a power of two. If this is a problem, since you're already modifying
-// core, change the lines in UART.cpp where it does & (SERIAL_xX_BUFFERLSIZE-1)
-// and replace them with % SERIAL_xX_BUFFER_SIZE; where xX is TX or RX.
-// There are two of each, and the old ending of the line is even commented
-// out at the end of the line.
+// a power of two. Since the size is now a property of each instance, we
+// store size - 1 as a mask, and wrapping an index is still a single and.
 #if (SERIAL_TX_BUFFER_SIZE & (SERIAL_TX_BUFFER_SIZE - 1))
   #error "ERROR: TX buffer size must be a power of two."
 #endif
 #if (SERIAL_RX_BUFFER_SIZE & (SERIAL_RX_BUFFER_SIZE - 1))
   #error "ERROR: RX buffer size must be a power of two."
 #endif
+#if ((SERIAL0_TX_BUFFER_SIZE & (SERIAL0_TX_BUFFER_SIZE - 1)) || (SERIAL1_TX_BUFFER_SIZE & (SERIAL1_TX_BUFFER_SIZE - 1)) || \
+     (SERIAL2_TX_BUFFER_SIZE & (SERIAL2_TX_BUFFER_SIZE - 1)) || (SERIAL3_TX_BUFFER_SIZE & (SERIAL3_TX_BUFFER_SIZE - 1)) || \
+     (SERIAL4_TX_BUFFER_SIZE & (SERIAL4_TX_BUFFER_SIZE - 1)) || (SERIAL5_TX_BUFFER_SIZE & (SERIAL5_TX_BUFFER_SIZE - 1)))
+  #error "ERROR: SERIALn_TX_BUFFER_SIZE must be a power of two."
+#endif
+#if ((SERIAL0_RX_BUFFER_SIZE & (SERIAL0_RX_BUFFER_SIZE - 1)) || (SERIAL1_RX_BUFFER_SIZE & (SERIAL1_RX_BUFFER_SIZE - 1)) || \
+     (SERIAL2_RX_BUFFER_SIZE & (SERIAL2_RX_BUFFER_SIZE - 1)) || (SERIAL3_RX_BUFFER_SIZE & (SERIAL3_RX_BUFFER_SIZE - 1)) || \
+     (SERIAL4_RX_BUFFER_SIZE & (SERIAL4_RX_BUFFER_SIZE - 1)) || (SERIAL5_RX_BUFFER_SIZE & (SERIAL5_RX_BUFFER_SIZE - 1)))
+  #error "ERROR: SERIALn_RX_BUFFER_SIZE must be a power of two."
+#endif
 
 /* Buffer sizing done */
 /* DANGER DANGER DANGER */
@@ -196,14 +262,49 @@
 // The buffer sizes can be overridden in by defining SERIAL_TX_BUFFER either in variant file (as defines in pins_arduino.h) or boards.txt (By passing them as extra flags).
 // note that buffer sizes must be powers of 2 only.
 
-#if USE_ASM_RXC == 1 && !(SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16)
-  #error "Assembly RX Complete (RXC) ISR is only supported when RX buffer size are 256, 128, 64, 32 or 16 bytes"
+/* Framed receive - see framedRx(). This costs every port a few bytes of RAM and some clocks in the RXC ISR, so it is only
+ * compiled in when SERIAL_FRAMED_RX is defined (as an extra flag, like the buffer sizes). The frame detection is done in the
+ * C RXC ISR, so this turns off the asm one. SERIAL_FRAME_QUEUE_SIZE is the number of complete frames that can be waiting
+ * for the sketch at once, and must be a power of 2.
+ */
+#if defined(SERIAL_FRAMED_RX)
+  #if !defined(SERIAL_FRAME_QUEUE_SIZE)
+    #define SERIAL_FRAME_QUEUE_SIZE 4
+  #endif
+  #if (SERIAL_FRAME_QUEUE_SIZE & (SERIAL_FRAME_QUEUE_SIZE - 1)) || SERIAL_FRAME_QUEUE_SIZE > 128
+    #error "ERROR: SERIAL_FRAME_QUEUE_SIZE must be a power of two no larger than 128."
+  #endif
+  #if defined(USE_ASM_RXC) && USE_ASM_RXC == 1
+    #undef  USE_ASM_RXC
+    #define USE_ASM_RXC 0
+  #endif
+  #define SERIAL_FRAME_NO_DELIMITER (-1)
+  typedef struct {
+    rx_buffer_index_t start;    // index into the RX buffer of the first byte
+    rx_buffer_index_t length;   // excluding the delimiter. Never 0; empty frames are not queued.
+  } serial_frame_t;
 #endif
 
-#if USE_ASM_DRE == 1 && !((SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16) && \
-                          (SERIAL_TX_BUFFER_SIZE == 256 || SERIAL_TX_BUFFER_SIZE == 128 || SERIAL_TX_BUFFER_SIZE == 64 || SERIAL_TX_BUFFER_SIZE == 32 || SERIAL_TX_BUFFER_SIZE == 16))
-  #error "Assembly Data Register Empty (DRE) ISR is only supported when both TX and RX buffer sizes are 256, 128, 64, 32 or 16 bytes"
+/* The asm ISRs take the buffer pointers and masks from the instance, so they work with any power of two buffer size up to 256.
+ * They only ever touch the low byte of an index, which is all there is to it for a buffer that size even when the indices are
+ * 16-bit, so the choice is made per port: a port whose SERIALn_xX_BUFFER_SIZE is over 256 gets the C implementation, and the
+ * rest keep the asm one - unless SERIAL_xX_INDEX_16BIT was defined by hand, in which case all ports get the C one. SERIAL_ASM_ISRS()
+ * gives the SERIAL_ASM_*_bm bits for a port with the given sizes, and works in #if too.
+ */
+#define SERIAL_ASM_RXC_bm 0x01
+#define SERIAL_ASM_DRE_bm 0x02
+#if defined(USE_ASM_RXC) && USE_ASM_RXC == 1 && !defined(SERIAL_RX_INDEX_USER)
+  #define SERIAL_ASM_RXC_MAX 256
+#else
+  #define SERIAL_ASM_RXC_MAX 0
 #endif
+#if defined(USE_ASM_DRE) && USE_ASM_DRE == 1 && !defined(SERIAL_TX_INDEX_USER)
+  #define SERIAL_ASM_DRE_MAX 256
+#else
+  #define SERIAL_ASM_DRE_MAX 0
+#endif
+#define SERIAL_ASM_ISRS(rx_size, tx_size) ((((rx_size) <= SERIAL_ASM_RXC_MAX) ? SERIAL_ASM_RXC_bm : 0) | \
+                                           (((tx_size) <= SERIAL_ASM_DRE_MAX) ? SERIAL_ASM_DRE_bm : 0))
 
 
 /* Macros to help the rare few who want sync or MSPI mode */
@@ -223,7 +324,7 @@
 class HardwareSerial : public Stream {
 /* DANGER DANGER DANGER
  * CHANGING THE MEMBER VARIABLES BETWEEN HERE AND THE OTHER SCARY COMMENT WILL COMPLETELY BREAK SERIAL
- * WHEN USE_ASM_DRE or USE_ASM_RXC is used!
+ * WHEN USE_ASM_DRE or USE_ASM_RXC is used! The offsets the asm uses are the SERIAL_OFS_* defines in UART.cpp.
  * DANGER DANGER DANGER */
  protected:
     volatile USART_t * _hwserial_module;  // pointer to the USART module, needed to access the correct registers.
@@ -235,21 +336,60 @@ class HardwareSerial : public Stream {
     volatile rx_buffer_index_t _rx_buffer_tail;
     volatile tx_buffer_index_t _tx_buffer_head;
     volatile tx_buffer_index_t _tx_buffer_tail;
-    // Don't put any members after these buffers, since only the first
-    // 32 bytes of this struct can be accessed quickly using the ldd
+    // Block TX - see writeBlock(). The DRE ISR sends from _block_ptr instead of the ring while the high byte of it is nonzero,
+    // which it always is for a pointer to RAM or mapped flash, so the asm only needs to test one byte to know which source to use.
+    const uint8_t * volatile _block_ptr;
+    volatile uint16_t _block_len;
+    void (* volatile _block_callback)(void);
+    // The buffers themselves are not part of the class, so each instance can have a different size, and you can supply your own.
+    // Size is always a power of 2, and we keep size - 1 since that's what we use to wrap the indices.
+    rx_buffer_index_t _rx_buffer_mask;
+    tx_buffer_index_t _tx_buffer_mask;
+    volatile uint8_t * _rx_buffer;
+    volatile uint8_t * _tx_buffer;
+    // Don't put anything that the ISRs need after this, since only the first
+    // 64 bytes of this struct can be accessed quickly using the ldd
     // instruction.
-    volatile uint8_t _rx_buffer[SERIAL_RX_BUFFER_SIZE];
-    volatile uint8_t _tx_buffer[SERIAL_TX_BUFFER_SIZE];
 /* DANGER DANGER DANGER */
 /* ANY CHANGES BETWEEN OTHER SCARY COMMENT AND THIS ONE WILL BREAK SERIAL IF THEY CHANGE RAM USED BY CLASS! */
 /* DANGER DANGER DANGER */
+    uint16_t _baud_nominal;                   // BAUD as calculated by begin(), so we can tell how far autobaud has moved it.
+  #if defined(SERIAL_RX_INDEX_16BIT) || defined(SERIAL_TX_INDEX_16BIT)
+    uint8_t _asm_isrs;                        // SERIAL_ASM_*_bm - which ISRs are the asm ones, and so can't take buffers over 256.
+  #endif
+  #if defined(SERIAL_FRAMED_RX)
+    // Frame state. Frames are stored contiguously in the RX buffer; _rx_buffer_tail is not used while framedRx() is on.
+    volatile uint8_t _frame_flags;            // see SERIAL_FRAME_*_bm in UART.cpp
+    uint8_t _frame_delimiter;
+    rx_buffer_index_t _frame_max;             // longest frame the sketch expects - used to decide when to go back to the start of the buffer
+    volatile rx_buffer_index_t _frame_start;  // where the frame being received started
+    volatile rx_buffer_index_t _frame_end;    // and how far it can go before it runs into a frame the sketch hasn't released.
+    volatile uint8_t _frame_q_head;
+    volatile uint8_t _frame_q_tail;
+    volatile serial_frame_t _frame_q[SERIAL_FRAME_QUEUE_SIZE];
+    TCB_t * _frame_timer;                     // restarted by every byte received, when framedRxTimeout() is used.
+    // transact() - the response goes in _xact_buf, which is NULL when no transaction is in progress.
+    uint8_t * volatile _xact_buf;
+    uint16_t _xact_max;
+    volatile uint16_t _xact_periods;          // how many more times the frame timer can run out before we give up.
+    volatile uint16_t _xact_result;
+    void (*_xact_callback)(uint16_t length);
+  #endif
 
   public:
-    inline             HardwareSerial(volatile USART_t *hwserial_module, uint8_t *usart_pins, uint8_t mux_count, uint8_t mux_default);
+    inline             HardwareSerial(volatile USART_t *hwserial_module, uint8_t *usart_pins, uint8_t mux_count, uint8_t mux_default,
+                                          volatile uint8_t *rx_buffer, uint16_t rx_size, volatile uint8_t *tx_buffer, uint16_t tx_size, uint8_t asm_isrs);
     bool                    pins(uint8_t tx, uint8_t rx);
     bool                    swap(uint8_t mux_level = 1);
     void                   begin(uint32_t baud) {begin(baud, SERIAL_8N1);}
     void                   begin(uint32_t baud, uint16_t options);
+    /* Use the supplied buffers instead of the default ones from now on. Sizes must be powers of 2 from 2 to SERIAL_xX_BUFFER_MAX
+     * (256, unless 16-bit indices are in use and this port's configured size is over 256, see above). A NULL pointer leaves that
+     * buffer as it was. If either size is invalid, returns false and changes nothing - the port isn't (re)started either.
+     * The buffers must stay valid for as long as the port is in use - global or static, not local variables! */
+    bool                   begin(uint32_t baud, uint16_t options, volatile uint8_t *rx_buffer, uint16_t rx_size, volatile uint8_t *tx_buffer, uint16_t tx_size);
+    uint16_t        rxBufferSize() {return (uint16_t)_rx_buffer_mask + 1;}
+    uint16_t        txBufferSize() {return (uint16_t)_tx_buffer_mask + 1;}
     void                     end();
     // printHex!
     void                  printHex(const     uint8_t  b); // in the cpp
@@ -315,25 +455,78 @@ class HardwareSerial : public Stream {
     inline   size_t write(long n)           {return write((uint8_t)n);}
     inline   size_t write(unsigned int n)   {return write((uint8_t)n);}
     inline   size_t write(int n)            {return write((uint8_t)n);}
-    using Print::write; // pull in write(str) and write(buf, size) from Print
+    using Print::write; // pull in write(str) from Print
+    virtual  size_t write(const uint8_t *buffer, size_t size); // copies straight into the TX buffer, as much at a time as fits.
+    /* reserve()/commit() - put data straight into the TX buffer, instead of calling write() for each byte. print() uses these.
+     * reserve(n) waits until there are n contiguous free bytes at the head of the TX buffer and returns a pointer to them, or returns
+     * NULL if there won't be, because the buffer wraps around before then (or n is 0 or not less than the buffer size) - in that case,
+     * use write(). Otherwise, put up to n bytes there and then commit() the number you put there, which sends them. Nothing else may
+     * write to this port between the two. */
+    virtual uint8_t *     reserve(size_t n);
+    virtual void           commit(size_t n);
+    /* writeBlock() - send len bytes straight out of a buffer owned by the caller, without copying them into the ring buffer.
+     * The DRE ISR loads them from the buffer directly, and once the last one has been handed to the USART, clears the busy flag and
+     * calls callback (if not NULL) from the ISR. The buffer must not be modified until writeBlockBusy() returns false. Anything
+     * written with write() in the meantime is queued in the ring and sent after the block. Returns the number of bytes queued. */
+    size_t        writeBlock(const uint8_t *buffer, size_t len, void (*callback)(void) = NULL);
+    bool      writeBlockBusy() {return !!(*(((volatile uint8_t *) &_block_ptr) + 1));} // only the high byte matters - see above.
+  #if defined(SERIAL_FRAMED_RX)
+    /* framedRx() - find frame boundaries in the RXC ISR, so the sketch gets whole frames instead of bytes. A frame ends when the delimiter
+     * is received (0x00 for COBS, 0xC0 for SLIP, or SERIAL_FRAME_NO_DELIMITER to use only the timeout) or when the line has been idle
+     * for the time given to framedRxTimeout(). The delimiter is not stored. Complete frames are queued until releaseFrame() is called;
+     * frames that don't fit in the buffer, or arrive when the queue is full, are discarded and reported as a ring buffer overflow by
+     * getStatus(). maxFrame is the longest frame you expect; it is used to keep each frame in one piece, and defaults to half the RX buffer.
+     * Don't use read(), peek() or available() while this is on. Ending it discards any frames not yet released. */
+    void                framedRx(int16_t delimiter = 0x00, uint16_t maxFrame = 0);
+    void             framedRxEnd();
+    /* Use timer (a TCB not in use for anything else) to end frames after the line has been idle for microseconds. You must also put
+     * SERIAL_FRAME_TIMEOUT_ISR(TCBn, Serialn) in your sketch, since the core can't claim the vectors of TCBs it doesn't otherwise use.
+     * Returns false if the time is too long for the timer at this clock speed (CLK_PER/2, so 65535 * 2 / F_CPU). */
+    bool         framedRxTimeout(TCB_t &timer, uint16_t microseconds);
+    uint8_t        framesWaiting() {return (uint8_t)(_frame_q_head - _frame_q_tail) & (SERIAL_FRAME_QUEUE_SIZE - 1);}
+    /* Returns the length of the oldest complete frame and points data at it, or returns 0 if there isn't one. The frame stays valid
+     * (and can be decoded in place) until releaseFrame(). */
+    uint16_t            getFrame(uint8_t **data);
+    void            releaseFrame();
+    /* transact() - send request and receive the response into response, for a master on a half duplex bus like RS485 (Modbus RTU, etc).
+     * Requires framedRx() and framedRxTimeout(), with the timeout set to the silence that ends a response (3.5 characters for Modbus).
+     * Returns false without doing anything if they haven't been called, or a transaction is already in progress; otherwise it returns
+     * as soon as the request is queued. While it is being sent, the receiver is ignored (as in half duplex mode, so we don't get our own
+     * echo), then the first frame received is copied into response (up to maxlen bytes, any more are lost), and callback (if not NULL)
+     * is called from the ISR with the length. If no response has ended within timeout ms of the call, callback is called with 0.
+     * Until then, request must not be changed. Frames already waiting when this is called are discarded. */
+    bool                transact(const uint8_t *request, uint16_t reqlen, uint8_t *response, uint16_t maxlen, uint16_t timeout, void (*callback)(uint16_t length) = NULL);
+    bool            transactBusy()   {return _xact_buf != NULL;}
+    uint16_t      transactLength()   {return _xact_result;} // length of the last response, or 0 if it timed out.
+  #endif
     explicit operator bool() {
       return true;
     }
+    /* Autobaud - see Ref_Serial.md. These return SERIAL_AUTOBAUD_DISABLED (0) if the port wasn't started with SERIAL_AUTOBAUD. */
     uint8_t autoBaudWFB();
+    uint8_t autobaudWFB() {return autoBaudWFB();} // the name the documentation has always used.
     void simpleSync();
     uint8_t autobaudWFB_and_wait(uint8_t n);
     uint8_t waitForSync();
     uint8_t autobaudWFB_and_request(uint8_t n = 2);
+    /* Baud rate telemetry. baudError() is how far the baud rate in use is from the one passed to begin(), in hundredths of a percent,
+     * positive if it is faster - with autobaud, this is how far off the other device (or our own clock) is. correctBaud() sets the
+     * baud rate that far from the nominal one, so an error measured by autobaud on one port can be applied to the others. */
+    int16_t baudError();
+    void correctBaud(int16_t error);
+    uint32_t currentBaud();
     uint8_t getStatus() {
       uint8_t ret = _statuscheck(_hwserial_module->CTRLB, _hwserial_module->STATUS, _state);
       if ((ret & 0x30) == 0x30) {
         _hwserial_module->STATUS = USART_ISFIF_bm;
         #if defined(ERRATA_ISFIF)
-          uint8_t ctrlb _hwserial_module->CTRLB;
+          uint8_t ctrlb = _hwserial_module->CTRLB;
           uint8_t rxoff = ctrlb & (~USART_RXEN_bm);
           _hwserial_module->CTRLB = rxoff;
           _hwserial_module->CTRLB = ctrlb;
         #endif
+      } else if ((ret & 0x30) == SERIAL_AUTOBAUD_SYNC) {
+        _hwserial_module->STATUS = USART_BDF_bm;  // so the next call reports SYNC only if there has been another sync since.
       }
       _state &= 0x03; // Clear the errors we just reported.
       return ret;
@@ -342,19 +535,24 @@ class HardwareSerial : public Stream {
     uint8_t getPin(uint8_t pin); //wrapper around static _getPin
 
     // Interrupt handlers - Not intended to be called externally
-    #if !(USE_ASM_RXC == 1 && \
-         (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16))
+    #if SERIAL_ASM_RXC_MAX == 0 || defined(SERIAL_RX_INDEX_16BIT)
       static void _rx_complete_irq(HardwareSerial& uartClass);
     #endif
-    #if !(USE_ASM_DRE == 1 && \
-         (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16) && \
-         (SERIAL_TX_BUFFER_SIZE == 256 || SERIAL_TX_BUFFER_SIZE == 128 || SERIAL_TX_BUFFER_SIZE == 64 || SERIAL_TX_BUFFER_SIZE == 32 || SERIAL_TX_BUFFER_SIZE == 16))
+    #if SERIAL_ASM_DRE_MAX == 0 || defined(SERIAL_TX_INDEX_16BIT)
       static void _tx_data_empty_irq(HardwareSerial& uartClass);
     #endif
+    #if defined(SERIAL_FRAMED_RX)
+      static void _frame_timeout_irq(HardwareSerial& uartClass);
+    #endif
 
   private:
     void                  _prtHxdw(uint8_t* p, bool s = 0); // internal, takes a pointer to a 32-bit type of any sort, reads it as bytes and prints.
+    void             _set_buffers(volatile uint8_t *rx_buffer, uint16_t rx_size, volatile uint8_t *tx_buffer, uint16_t tx_size);
     void _poll_tx_data_empty(void);
+  #if defined(SERIAL_FRAMED_RX)
+    static void     _frame_close(HardwareSerial& uartClass);
+    static void      _xact_done(HardwareSerial& uartClass, uint16_t length);
+  #endif
     /* These all concern pin set handling */
     static void        _set_pins(uint8_t* pinInfo, uint8_t mux_count, uint8_t mux_setting,  uint8_t enmask);
     static void         _mux_set(uint8_t* pinInfo, uint8_t mux_count, uint8_t mux_code                    );
@@ -420,4 +618,9 @@ class HardwareSerial : public Stream {
   extern HardwareSerial Serial5;
 #endif
 
+#if defined(SERIAL_FRAMED_RX)
+  // Put this in the sketch for the TCB passed to framedRxTimeout(), eg: SERIAL_FRAME_TIMEOUT_ISR(TCB1, Serial2)
+  #define SERIAL_FRAME_TIMEOUT_ISR(tcb, port) ISR(tcb##_INT_vect) {HardwareSerial::_frame_timeout_irq(port);}
+#endif
+
 // Why was there ever a class called UpdiClass? It was UartClass...
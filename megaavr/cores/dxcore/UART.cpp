@@ -26,12 +26,46 @@
 #if defined(USART0) || defined(USART1) || defined(USART2) || defined(USART3) || defined(USART4) || defined(USART5)
 
   #if defined(HAVE_HWSERIAL0) || defined(HAVE_HWSERIAL1) || defined(HAVE_HWSERIAL2) || defined(HAVE_HWSERIAL3) || defined(HAVE_HWSERIAL4) || defined(HAVE_HWSERIAL5)
-    // macro to guard critical sections when needed for large TX buffer sizes
-    #if (SERIAL_TX_BUFFER_SIZE > 256)
+    // macro to guard critical sections when needed for large buffer sizes - reading a 16-bit index that an ISR may change mid-read.
+    #if defined(SERIAL_TX_INDEX_16BIT)
       #define TX_BUFFER_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
     #else
       #define TX_BUFFER_ATOMIC
     #endif
+    #if defined(SERIAL_RX_INDEX_16BIT)
+      #define RX_BUFFER_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    #else
+      #define RX_BUFFER_ATOMIC
+    #endif
+    // Where the asm ISRs find things in HardwareSerial - see the DANGER comments there. With 16-bit indices, everything from the
+    // indices on moves up; the asm still only touches the low byte of an index, which is all a port that uses it needs.
+    #if defined(SERIAL_TX_INDEX_16BIT)
+      #define SERIAL_TX_INDEX_BYTES 2
+    #else
+      #define SERIAL_TX_INDEX_BYTES 1
+    #endif
+    #if defined(SERIAL_RX_INDEX_16BIT)
+      #define SERIAL_RX_INDEX_BYTES 2
+    #else
+      #define SERIAL_RX_INDEX_BYTES 1
+    #endif
+    #define SERIAL_OFS_RX_HEAD    15
+    #define SERIAL_OFS_RX_TAIL    (SERIAL_OFS_RX_HEAD   + SERIAL_RX_INDEX_BYTES)
+    #define SERIAL_OFS_TX_HEAD    (SERIAL_OFS_RX_TAIL   + SERIAL_RX_INDEX_BYTES)
+    #define SERIAL_OFS_TX_TAIL    (SERIAL_OFS_TX_HEAD   + SERIAL_TX_INDEX_BYTES)
+    #define SERIAL_OFS_BLOCK_PTR  (SERIAL_OFS_TX_TAIL   + SERIAL_TX_INDEX_BYTES)
+    #define SERIAL_OFS_BLOCK_LEN  (SERIAL_OFS_BLOCK_PTR + 2)
+    #define SERIAL_OFS_BLOCK_CB   (SERIAL_OFS_BLOCK_LEN + 2)
+    #define SERIAL_OFS_RX_MASK    (SERIAL_OFS_BLOCK_CB  + 2)
+    #define SERIAL_OFS_TX_MASK    (SERIAL_OFS_RX_MASK   + SERIAL_RX_INDEX_BYTES)
+    #define SERIAL_OFS_RX_BUFFER  (SERIAL_OFS_TX_MASK   + SERIAL_TX_INDEX_BYTES)
+    #define SERIAL_OFS_TX_BUFFER  (SERIAL_OFS_RX_BUFFER + 2)
+    #if defined(SERIAL_FRAMED_RX)
+      #define SERIAL_FRAME_ON_bm      0x01 // framedRx() is on.
+      #define SERIAL_FRAME_DELIM_bm   0x02 // a delimiter is in use.
+      #define SERIAL_FRAME_OPEN_bm    0x04 // a frame has started - _frame_start and _frame_end are valid.
+      #define SERIAL_FRAME_DISCARD_bm 0x08 // the frame being received is bad or won't fit. Drop everything until it ends.
+    #endif
 
     /*##  ###  ####
       #  #     #   #
@@ -169,7 +203,7 @@
 
     */
 
-    #if ((USE_ASM_RXC == 1) && (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16) )
+    #if SERIAL_ASM_RXC_MAX
       void __attribute__((naked)) __attribute__((used)) __attribute__((noreturn)) _do_rxc(void) {
         __asm__ __volatile__(
           "_do_rxc:"                      "\n\t" // We start out 11-13 clocks after the interrupt
@@ -208,29 +242,21 @@
             //"rjmp  _end_rxc"              "\n\t"
     //       "storechar:"
     //#endif
-            "ldd        r28,    Z + 15"   "\n\t" // load current head index
+            "ldd        r28, Z + %[rxhead]"   "\n\t" // load current head index
             "ldi        r24,         1"   "\n\t" // Clear r24 and initialize it with 1
             "add        r24,       r28"   "\n\t" // add current head index to it
-    #if   SERIAL_RX_BUFFER_SIZE == 256
-            // No additional action needed, head wraps naturally.
-    #elif SERIAL_RX_BUFFER_SIZE == 128
-            "andi       r24,      0x7F"   "\n\t" // Wrap the head around
-    #elif SERIAL_RX_BUFFER_SIZE == 64
-            "andi       r24,      0x3F"   "\n\t" // Wrap the head around
-    #elif SERIAL_RX_BUFFER_SIZE == 32
-            "andi       r24,      0x1F"   "\n\t" // Wrap the head around
-    #elif SERIAL_RX_BUFFER_SIZE == 16
-            "andi       r24,      0x0F"   "\n\t" // Wrap the head around
-    #endif
-            "ldd        r18,    Z + 16"   "\n\t" // load tail index This to _end_rxc is 11 clocks unless the buffer was full, in which case it's 8.
+            "ldd        r18, Z + %[rxmask]"   "\n\t" // _rx_buffer_mask - size of this instance's buffer - 1
+            "and        r24,       r18"   "\n\t" // Wrap the head around (a 256 byte buffer has a mask of 0xFF, so this does nothing, like it should).
+            "ldd        r18, Z + %[rxtail]"   "\n\t" // load tail index This to _end_rxc is 15 clocks unless the buffer was full, in which case it's 10.
             "cp         r18,       r24"   "\n\t" // See if head is at tail. If so, buffer full. The incoming data is discarded,
             "breq  _buff_full_rxc"        "\n\t" // because there is noplace to put it, and we just restore state and leave.
-            "add        r28,       r30"   "\n\t" // r28 has what would be the next index in it.
-            "mov        r29,       r31"   "\n\t" // and this is the high byte of serial instance
+            "ldd        r18, Z + %[rxbuf]"   "\n\t" // low byte of _rx_buffer
+            "add        r28,       r18"   "\n\t" // r28 has the current head index in it.
+            "ldd        r29, Z + %[rxbufh]"   "\n\t" // high byte of _rx_buffer (ldd and ldi leave the carry alone)
             "ldi        r18,         0"   "\n\t" // need a known zero to carry.
-            "adc        r29,       r18"   "\n\t" // carry - Y is now pointing 19 bytes before head
-            "std     Y + 19,       r25"   "\n\t" // store the new char in buffer
-            "std     Z + 15,       r24"   "\n\t" // write that new head index.
+            "adc        r29,       r18"   "\n\t" // carry - Y is now pointing at the head of the buffer
+            "st               Y,   r25"   "\n\t" // store the new char in buffer
+            "std Z + %[rxhead],  r24"   "\n\t" // write that new head index.
           "_end_rxc:"                     "\n\t"
             "std     Z + 14,       r19"   "\n\t" // record new state including new errors
                                        // Epilogue: 9 pops + 1 out + 1 reti +1 std = 24 clocks
@@ -248,13 +274,14 @@
           "_buff_full_rxc:"               "\n\t" // _buff_full_rxc moved to after the reti, and then rjmps back, saving 2 clocks for the common case
             "ori        r19,      0x40"   "\n\t" // record that there was a ring buffer overflow. 1 clk
             "rjmp _end_rxc"               "\n\t" // and now jump back to end. That way we don't need to jump over this in the middle of the common case.
-            ::); // total: 77 or 79 clocks, just barely squeaks by for cyclic RX of up to RX_BUFFER_SIZE characters.
+            :: [rxhead] "n" (SERIAL_OFS_RX_HEAD),   [rxtail] "n" (SERIAL_OFS_RX_TAIL),   [rxmask] "n" (SERIAL_OFS_RX_MASK),
+               [rxbuf]  "n" (SERIAL_OFS_RX_BUFFER), [rxbufh] "n" (SERIAL_OFS_RX_BUFFER + 1)); // total: 81 or 83 clocks, just barely squeaks by for cyclic RX of up to RX_BUFFER_SIZE characters.
         __builtin_unreachable();
 
       }
-    #elif defined(USE_ASM_RXC) && USE_ASM_RXC == 1
-      #warning "USE_ASM_RXC is defined and this has more than one serial port, but the buffer size is not supported, falling back to the classical RXC."
-    #else
+    #endif
+    // Ports configured over 256 bytes use this one even when the asm one is in use for the others.
+    #if SERIAL_ASM_RXC_MAX == 0 || defined(SERIAL_RX_INDEX_16BIT)
       #if defined(PERMIT_USART_WAKE)
         #error "USART Wake is not supported by the non-ASM RXC interrupt handler"
       #endif
@@ -263,15 +290,56 @@
         uint8_t rxDataH = HardwareSerial._hwserial_module->RXDATAH;
         uint8_t       c = HardwareSerial._hwserial_module->RXDATAL;  // no need to read the data twice. read it, then decide what to do
         rx_buffer_index_t rxHead = HardwareSerial._rx_buffer_head;
+      #if defined(SERIAL_FRAMED_RX)
+        uint8_t flags = HardwareSerial._frame_flags;
+        if (flags & SERIAL_FRAME_ON_bm) {
+          TCB_t * timer = HardwareSerial._frame_timer;
+          if (timer) {                          // restart the idle timer.
+            timer->CNT    = 0;
+            timer->CTRLA |= TCB_ENABLE_bm;
+          }
+          if (rxDataH & USART_PERR_bm) {        // a bad byte spoils the whole frame.
+            flags |= SERIAL_FRAME_OPEN_bm | SERIAL_FRAME_DISCARD_bm;
+          } else if ((flags & SERIAL_FRAME_DELIM_bm) && c == HardwareSerial._frame_delimiter) {
+            _frame_close(HardwareSerial);
+            return;
+          } else if (!(flags & SERIAL_FRAME_DISCARD_bm)) {
+            if (!(flags & SERIAL_FRAME_OPEN_bm)) {
+              // First byte of a frame. Work out where it goes so that it will be in one piece: Frames are released in the order they
+              // arrived, so the free space is from the head to the start of the oldest frame still queued, wrapping around the end.
+              flags |= SERIAL_FRAME_OPEN_bm;
+              rx_buffer_index_t end = HardwareSerial._rx_buffer_mask;
+              uint8_t qtail = HardwareSerial._frame_q_tail;
+              if (qtail == HardwareSerial._frame_q_head) {
+                rxHead = 0;                     // Nothing queued - start over at the beginning, which is by far the most common case.
+              } else {
+                rx_buffer_index_t oldest = HardwareSerial._frame_q[qtail].start;
+                if (oldest > rxHead) {
+                  end = oldest - 1;
+                } else if ((rx_buffer_index_t)(end - rxHead) < HardwareSerial._frame_max && oldest > HardwareSerial._frame_max) {
+                  rxHead = 0;                   // a maximum length frame won't fit before the end, but will at the start.
+                  end = oldest - 1;
+                }
+              }
+              HardwareSerial._frame_start = rxHead;
+              HardwareSerial._frame_end   = end;
+            }
+            if (rxHead < HardwareSerial._frame_end) {
+              HardwareSerial._rx_buffer[rxHead++] = c;
+              HardwareSerial._rx_buffer_head = rxHead;
+            } else {
+              flags |= SERIAL_FRAME_DISCARD_bm;
+            }
+          }
+          HardwareSerial._frame_flags = flags;
+          return;
+        }
+      #endif
 
         if (!(rxDataH & USART_PERR_bm)) {
           // No Parity error, read byte and store it in the buffer if there is room
           // unsigned char c = HardwareSerial._hwserial_module->RXDATAL;
-          #if SERIAL_RX_BUFFER_SIZE > 256
-            rx_buffer_index_t i = (uint16_t)(rxHead + 1) % SERIAL_RX_BUFFER_SIZE;
-          #else
-            rx_buffer_index_t i = (uint8_t)(rxHead + 1) % SERIAL_RX_BUFFER_SIZE;
-          #endif
+          rx_buffer_index_t i = (rx_buffer_index_t)(rxHead + 1) & HardwareSerial._rx_buffer_mask;
 
           // if we should be storing the received character into the location
           // just before the tail (meaning that the head would advance to the
@@ -298,8 +366,7 @@
 
     */
 
-    #if USE_ASM_DRE == 1 && (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16) && \
-                            (SERIAL_TX_BUFFER_SIZE == 256 || SERIAL_TX_BUFFER_SIZE == 128 || SERIAL_TX_BUFFER_SIZE == 64 || SERIAL_TX_BUFFER_SIZE == 32 || SERIAL_TX_BUFFER_SIZE == 16)
+    #if SERIAL_ASM_DRE_MAX
       void __attribute__((naked)) __attribute__((used)) __attribute__((noreturn)) _do_dre(void) {
         __asm__ __volatile__(
         "_do_dre:"                        "\n\t"
@@ -318,53 +385,30 @@
           "ldd         r28,   Z +  8"     "\n\t"  // usart in Y low byte
     //    "ldd         r29,   Z +  9"     "\n\t"  // usart in Y high byte - wait, this is constant!
           "ldi         r29,     0x08"     "\n\t"  // High byte always 0x08 for USART peripheral: Save-a-clock.
-          "ldd         r25,   Z + 18"     "\n\t"  // tx tail in r25
-          "movw        r26,      r30"     "\n\t"  // copy of serial in X
-          "add         r26,      r25"     "\n\t"  // SerialN + txtail
-          "adc         r27,      r18"     "\n\t"  // X = &Serial + txtail
-    #if   SERIAL_RX_BUFFER_SIZE == 256            // RX buffer determines offset from start of class to TX buffer
-          "subi        r26,     0xED"     "\n\t"  // There's no addi/adci, so we instead subtract (65536-(offset we want to add))
-          "sbci        r27,     0xFE"     "\n\t"  // +273
-          "ld          r24,        X"     "\n\t"  // grab the character
-    #elif SERIAL_RX_BUFFER_SIZE == 128
-          "subi        r26,     0x6D"     "\n\t"  //
-          "sbci        r27,     0xFF"     "\n\t"  // +145
-          "ld          r24,        X"     "\n\t"  // grab the character
-    #elif SERIAL_RX_BUFFER_SIZE == 64
-          "subi        r26,     0xAD"     "\n\t"  //
-          "sbci        r27,     0xFF"     "\n\t"  // +81
-          "ld          r24,        X"     "\n\t"  // grab the character
-    #elif SERIAL_RX_BUFFER_SIZE == 32
-          "adiw        r26,     0x33"     "\n\t"  // +49
-          "ld          r24,        X"     "\n\t"  // grab the character
-    #elif SERIAL_RX_BUFFER_SIZE == 16
-          "adiw        r26,     0x23"     "\n\t"  // +33
+          "ldd         r27,   Z + %[bptrh]"     "\n\t"  // high byte of _block_ptr - nonzero if and only if writeBlock() has a block in progress
+          "cpse        r27,      r18"     "\n\t"  // if it's zero, skip the jump and use the ring buffer like normal.
+          "rjmp  _dre_block"              "\n\t"  // 3 clocks on the ring buffer path for this.
+          "ldd         r25,   Z + %[txtail]"     "\n\t"  // tx tail in r25
+          "ldd         r26,   Z + %[txbuf]"     "\n\t"  // _tx_buffer in X
+          "ldd         r27,   Z + %[txbufh]"     "\n\t"  //
+          "add         r26,      r25"     "\n\t"  // _tx_buffer + txtail
+          "adc         r27,      r18"     "\n\t"  // X = &_tx_buffer[txtail]
           "ld          r24,        X"     "\n\t"  // grab the character
-    #endif
           "ldi         r18,     0x40"     "\n\t"
           "std       Y + 4,      r18"     "\n\t" // Y + 4 = USART.STATUS - clear TXC
           "std       Y + 2,      r24"     "\n\t" // Y + 2 = USART.TXDATAL - write char
           "subi        r25,     0xFF"     "\n\t" // increment txtail, we wrote that character
-          // Now we need to deal with the counter running over, because then the tail has to be at the 0 index of the buffer
-    #if   SERIAL_TX_BUFFER_SIZE == 256
-    //    // No action needed to wrap the tail around -
-    #elif SERIAL_TX_BUFFER_SIZE == 128
-          "andi        r25,     0x7F"     "\n\t" // Wrap the tail around
-    #elif SERIAL_TX_BUFFER_SIZE == 64
-          "andi        r25,     0x3F"     "\n\t" // Wrap the tail around
-    #elif SERIAL_TX_BUFFER_SIZE == 32
-          "andi        r25,     0x1F"     "\n\t" // Wrap the tail around
-    #elif SERIAL_TX_BUFFER_SIZE == 16
-          "andi        r25,     0x0F"     "\n\t" // Wrap the tail around
-    #endif
+          "ldd         r18,   Z + %[txmask]"     "\n\t" // Now we need to deal with the counter running over, because then the tail has to be at the 0 index of the buffer
+          "and         r25,      r18"     "\n\t" // so wrap the tail around with _tx_buffer_mask
           "ldd         r24,   Y +  5"     "\n\t"  // Y + 5 = USART.CTRLA - get CTRLA into r24
-          "ldd         r18,   Z + 17"     "\n\t"  // txhead into r18
+          "ldd         r18,   Z + %[txhead]"     "\n\t"  // txhead into r18
           "cpse        r18,      r25"     "\n\t"  // if they're the same
           "rjmp  _done_dre_irq"           "\n\t"  // Skipped unless buffer empty.
           "andi        r24,     0xDF"     "\n\t"  // DREIE off
           "std      Y +  5,      r24"     "\n\t"  // write new ctrla
         "_done_dre_irq:"                  "\n\t"  // Beginning of the end of DRE
-          "std      Z + 18,      r25"     "\n\t"  // store new tail
+          "std      Z + %[txtail],      r25"     "\n\t"  // store new tail
+        "_end_dre:"                       "\n\t"  // The block path rejoins here.
           "pop         r29"               "\n\t"  // pop Y
           "pop         r28"               "\n\t"  // finish popping Y
     #if PROGMEM_SIZE > 8192
@@ -383,15 +427,99 @@
           "pop         r18"               "\n\t"  // pop old r18
           "pop         r31"               "\n\t"  // pop the Z that the isr pushed.
           "pop         r30"               "\n\t"
-          "reti"                          "\n"   // and RETI!
-          ::);
+          "reti"                          "\n\t"  // and RETI!
+        /* Block TX, see writeBlock(). Kept out of line so the ring buffer path only pays for the test above.
+         * Entered with r18 = 0, Y = USART, r27 = high byte of _block_ptr. Per byte this is about as long as the ring path, but
+         * there was no write() call and no copy to get the data here. */
+        "_dre_block:"                     "\n\t"
+          "ldd         r26,   Z + %[bptr]"     "\n\t"  // X = _block_ptr
+          "ld          r24,       X+"     "\n\t"  // grab the character, and advance the pointer.
+          "ldi         r25,     0x40"     "\n\t"
+          "std       Y + 4,      r25"     "\n\t"  // Y + 4 = USART.STATUS - clear TXC
+          "std       Y + 2,      r24"     "\n\t"  // Y + 2 = USART.TXDATAL - write char
+          "ldd         r24,   Z + %[blen]"     "\n\t"  // _block_len
+          "ldd         r25,   Z + %[blenh]"     "\n\t"
+          "sbiw        r24,        1"     "\n\t"  // one less to go
+          "std      Z + %[blen],      r24"     "\n\t"
+          "std      Z + %[blenh],      r25"     "\n\t"
+          "breq  _dre_block_done"         "\n\t"  // sbiw set Z if that was the last one; std doesn't touch SREG.
+          "std      Z + %[bptr],      r26"     "\n\t"  // otherwise store the advanced pointer
+          "std      Z + %[bptrh],      r27"     "\n\t"
+          "rjmp  _end_dre"                "\n\t"  // and leave.
+        "_dre_block_done:"                "\n\t"
+          "std      Z + %[bptrh],      r18"     "\n\t"  // clear _block_ptr. The high byte is what marks the block as finished.
+          "std      Z + %[bptr],      r18"     "\n\t"
+          "ldd         r24,   Z + %[txhead]"     "\n\t"  // txhead
+          "ldd         r25,   Z + %[txtail]"     "\n\t"  // txtail
+          "cpse        r24,      r25"     "\n\t"  // if anything was written to the ring while the block was going out
+          "rjmp  _dre_block_cb"           "\n\t"  // leave DREIE on so that gets sent next.
+          "ldd         r24,   Y +  5"     "\n\t"  // otherwise, Y + 5 = USART.CTRLA
+          "andi        r24,     0xDF"     "\n\t"  // DREIE off
+          "std      Y +  5,      r24"     "\n\t"  // write new ctrla
+        "_dre_block_cb:"                  "\n\t"
+          "ldd         r26,   Z + %[bcb]"     "\n\t"  // _block_callback
+          "ldd         r27,   Z + %[bcbh]"     "\n\t"
+          "adiw        r26,        0"     "\n\t"  // sets Z flag if it's NULL
+          "breq  _end_dre"                "\n\t"  // in which case we're done.
+          "push         r0"               "\n\t"  // Calling a normal function, so we need to save everything that it's allowed to clobber that we haven't already.
+          "push         r1"               "\n\t"
+          "push        r19"               "\n\t"
+          "push        r20"               "\n\t"
+          "push        r21"               "\n\t"
+          "push        r22"               "\n\t"
+          "push        r23"               "\n\t"
+          "push        r30"               "\n\t"
+          "push        r31"               "\n\t"
+          "in          r24,     0x3F"     "\n\t"  // The callback could clobber the T flag, which tells us how to leave.
+          "push        r24"               "\n\t"
+          "clr          r1"               "\n\t"  // known zero for the callee
+          "movw        r30,      r26"     "\n\t"
+          "icall"                         "\n\t"  // Once per block, so the cost of this hardly matters.
+          "pop         r24"               "\n\t"
+          "out        0x3F,      r24"     "\n\t"
+          "pop         r31"               "\n\t"
+          "pop         r30"               "\n\t"
+          "pop         r23"               "\n\t"
+          "pop         r22"               "\n\t"
+          "pop         r21"               "\n\t"
+          "pop         r20"               "\n\t"
+          "pop         r19"               "\n\t"
+          "pop          r1"               "\n\t"
+          "pop          r0"               "\n\t"
+          "rjmp  _end_dre"                "\n"
+          :: [txhead] "n" (SERIAL_OFS_TX_HEAD),       [txtail] "n" (SERIAL_OFS_TX_TAIL),       [txmask] "n" (SERIAL_OFS_TX_MASK),
+             [txbuf]  "n" (SERIAL_OFS_TX_BUFFER),     [txbufh] "n" (SERIAL_OFS_TX_BUFFER + 1),
+             [bptr]   "n" (SERIAL_OFS_BLOCK_PTR),     [bptrh]  "n" (SERIAL_OFS_BLOCK_PTR + 1),
+             [blen]   "n" (SERIAL_OFS_BLOCK_LEN),     [blenh]  "n" (SERIAL_OFS_BLOCK_LEN + 1),
+             [bcb]    "n" (SERIAL_OFS_BLOCK_CB),      [bcbh]   "n" (SERIAL_OFS_BLOCK_CB + 1));
         __builtin_unreachable();
       }
-    #elif USE_ASM_DRE == 1
-      #warning "USE_ASM_DRE == 1, but the buffer sizes are not supported, falling back to the classical DRE."
-    #else
+    #endif
+    // Likewise, ports configured over 256 bytes use this one.
+    #if SERIAL_ASM_DRE_MAX == 0 || defined(SERIAL_TX_INDEX_16BIT)
       void HardwareSerial::_tx_data_empty_irq(HardwareSerial& HardwareSerial) {
         USART_t* usartModule      = (USART_t*)HardwareSerial._hwserial_module;  // reduces size a little bit
+        const uint8_t * blockPtr  = HardwareSerial._block_ptr;
+        if (blockPtr) {
+          // writeBlock() in progress - it goes out before anything in the ring.
+          usartModule->STATUS = USART_TXCIF_bm;
+          usartModule->TXDATAL = *blockPtr++;
+          uint16_t blockLen = HardwareSerial._block_len - 1;
+          HardwareSerial._block_len = blockLen;
+          if (blockLen) {
+            HardwareSerial._block_ptr = blockPtr;
+            return;
+          }
+          HardwareSerial._block_ptr = NULL;
+          if (HardwareSerial._tx_buffer_head == HardwareSerial._tx_buffer_tail) {
+            usartModule->CTRLA &= ~(USART_DREIE_bm);
+          }
+          void (*callback)(void) = HardwareSerial._block_callback;
+          if (callback) {
+            callback();
+          }
+          return;
+        }
         tx_buffer_index_t txTail  = HardwareSerial._tx_buffer_tail;
 
         // Check if tx buffer already empty. when called by _poll_tx_data_empty()
@@ -411,7 +539,7 @@
         usartModule->STATUS = USART_TXCIF_bm;
         usartModule->TXDATAL = c;
 
-        txTail = (txTail + 1) & (SERIAL_TX_BUFFER_SIZE - 1);  //% SERIAL_TX_BUFFER_SIZE;
+        txTail = (txTail + 1) & HardwareSerial._tx_buffer_mask;
         uint8_t ctrla = usartModule->CTRLA;
         if (HardwareSerial._tx_buffer_head == txTail) {
           // Buffer empty, so disable "data register empty" interrupt
@@ -442,16 +570,21 @@
         // -Spence 10/23/20
         // Invoke interrupt handler only if conditions data register is empty
         if ((*_hwserial_module).STATUS & USART_DREIF_bm) {
-          if (_tx_buffer_head == _tx_buffer_tail) {
-            // Buffer empty, so disable "data register empty" interrupt
+          if (_tx_buffer_head == _tx_buffer_tail && !writeBlockBusy()) {
+            // Buffer empty and no block being sent, so disable "data register empty" interrupt
             (*_hwserial_module).CTRLA &= (~USART_DREIE_bm);
 
             return;
           }
-    #if !(USE_ASM_DRE == 1 && (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128  || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16) && \
-                              (SERIAL_TX_BUFFER_SIZE == 256 || SERIAL_TX_BUFFER_SIZE == 128  || SERIAL_TX_BUFFER_SIZE == 64 || SERIAL_TX_BUFFER_SIZE == 32 || SERIAL_TX_BUFFER_SIZE == 16))
+    #if SERIAL_ASM_DRE_MAX == 0
             _tx_data_empty_irq(*this);
     #else // We're using ASM DRE
+      #if defined(SERIAL_TX_INDEX_16BIT)
+            if (!(_asm_isrs & SERIAL_ASM_DRE_bm)) {  // unless this port is one of the big ones.
+              _tx_data_empty_irq(*this);
+              return;
+            }
+      #endif
       #ifdef USART1
         void * thisSerial = this;
       #endif
@@ -555,13 +688,17 @@
       uint8_t ctrla = (uint8_t) (options >> 8);// CTRLA will get the remains of the options high byte.
       uint16_t baud_setting = 0;                // at this point it should be able to reuse those 2 registers that it received options in!
       uint8_t   ctrlb = (~ctrla & 0xC0);        // Top two bits (TXEN RXEN), inverted so they match he sense in the registers.
-      if (baud   > F_CPU / 16) {            // if this baud is too fast for non-U2X
+      if (baud & SERIAL_AUTOBAUD) {             // Generic autobaud. It uses the same RXMODE bits as U2X, so U2X isn't an option.
+        baud    &= ~SERIAL_AUTOBAUD;
+        ctrlb   |= USART_RXMODE_GENAUTO_gc;     // Any break + sync received from now on will set BAUD.
+      } else if (baud   > F_CPU / 16) {     // if this baud is too fast for non-U2X
             ctrlb   |= USART_RXMODE0_bm;        // set the U2X bit in what will become CTRLB
             baud   >>= 1;                       // And lower the baud rate by haldf
       }
       baud_setting = (((4 * F_CPU) / baud));  // And now the registers that baud was passed in are done.
       if (baud_setting < 64)                      // so set to the maximum baud rate setting.
         baud_setting= 64;       // set the U2X bit in what will become CTRLB
+      _baud_nominal = baud_setting;
       //} else if (baud < (F_CPU / 16800)) {      // Baud rate is too low
       //  baud_setting = 65535;                   // minimum baud rate.'
                                                 // Baud setting done now we do the other options not in CTRLC;
@@ -601,6 +738,53 @@
       SREG = oldSREG;                             // re-enable interrupts, and we're done.
     }
 
+    bool HardwareSerial::begin(unsigned long baud, uint16_t options, volatile uint8_t *rx_buffer, uint16_t rx_size, volatile uint8_t *tx_buffer, uint16_t tx_size) {
+      uint16_t rx_max = SERIAL_RX_BUFFER_MAX;
+      uint16_t tx_max = SERIAL_TX_BUFFER_MAX;
+      #if defined(SERIAL_RX_INDEX_16BIT)
+        if (_asm_isrs & SERIAL_ASM_RXC_bm) {    // the asm ISR only handles the low byte of the index.
+          rx_max = 256;
+        }
+      #endif
+      #if defined(SERIAL_TX_INDEX_16BIT)
+        if (_asm_isrs & SERIAL_ASM_DRE_bm) {
+          tx_max = 256;
+        }
+      #endif
+      if ((rx_buffer && (rx_size < 2 || rx_size > rx_max || (rx_size & (rx_size - 1)))) ||
+          (tx_buffer && (tx_size < 2 || tx_size > tx_max || (tx_size & (tx_size - 1))))) {
+        return false;                           // Checked before anything is touched, so a bad size leaves the port as it was.
+      }
+      if (_state & 1) {                         // Anything still in the old TX buffer needs to go out before we let go of it.
+        this->end();
+      }
+      _set_buffers(rx_buffer, rx_size, tx_buffer, tx_size);
+      begin(baud, options);
+      return true;
+    }
+
+    // Sizes have already been checked by begin(). A NULL buffer is left as it was.
+    void HardwareSerial::_set_buffers(volatile uint8_t *rx_buffer, uint16_t rx_size, volatile uint8_t *tx_buffer, uint16_t tx_size) {
+      uint8_t oldSREG = SREG;
+      cli();                                    // The RXC ISR could otherwise fire between changing the pointer and the mask.
+      if (rx_buffer) {
+        _rx_buffer      = rx_buffer;
+        _rx_buffer_mask = (rx_buffer_index_t)(rx_size - 1);
+        _rx_buffer_head = 0;                    // whatever was in the old buffer is gone.
+        _rx_buffer_tail = 0;
+        #if defined(SERIAL_FRAMED_RX)
+          _frame_flags    = 0;                  // _frame_max may not be valid for the new buffer. Call framedRx() again.
+        #endif
+      }
+      if (tx_buffer) {
+        _tx_buffer      = tx_buffer;            // Nothing can be in the TX buffer; begin() flushed it if we had ever written anything.
+        _tx_buffer_mask = (tx_buffer_index_t)(tx_size - 1);
+        _tx_buffer_head = 0;
+        _tx_buffer_tail = 0;
+      }
+      SREG = oldSREG;
+    }
+
 // Static
     void HardwareSerial::_mux_set(uint8_t* mux_table_ptr, uint8_t mux_count, uint8_t mux_code) {
     #if HWSERIAL_MUX_REG_COUNT > 1  // for big pincount devices that have more then one USART PORTMUX register
@@ -696,18 +880,127 @@
       temp -> STATUS =  USART_TXCIF_bm | USART_RXCIF_bm; // want to make sure no chance of that firing in error now that the USART is off. TXCIE only used in half duplex
       // clear any received data
       _rx_buffer_head = _rx_buffer_tail;
+      #if defined(SERIAL_FRAMED_RX)
+        framedRxEnd();
+      #endif
 
       // Note: Does not change output pins
       // though the datasheetsays turning the TX module off sets it to input.
       _state = 0;
     }
 
+    uint8_t HardwareSerial::autoBaudWFB() {
+      volatile USART_t * usart = _hwserial_module;
+      if ((usart->CTRLB & USART_RXMODE_gm) != USART_RXMODE_GENAUTO_gc) {
+        return SERIAL_AUTOBAUD_DISABLED;
+      }
+      usart->STATUS = USART_WFB_bm;             // The next low of any length is taken as a break, and must be followed by a sync.
+      return SERIAL_AUTOBAUD_ENABLED;
+    }
+
+    void HardwareSerial::simpleSync() {
+      rx_buffer_index_t head;
+      RX_BUFFER_ATOMIC {
+        head = _rx_buffer_head;
+      }
+      _rx_buffer_tail = head;                   // Anything received before the other side has the right baud rate is garbage.
+      write((uint8_t) 0x00);                    // Long enough to look like a break if the other side is faster than us or waiting for one,
+      write((uint8_t) 0x55);                    // and the sync.
+    }
+
+    uint8_t HardwareSerial::waitForSync() {
+      volatile USART_t * usart = _hwserial_module;
+      if ((usart->CTRLB & USART_RXMODE_gm) != USART_RXMODE_GENAUTO_gc) {
+        return SERIAL_AUTOBAUD_DISABLED;
+      }
+      usart->STATUS = USART_BDF_bm;             // clear any old sync so we only see a new one.
+      for (uint16_t i = 0; i < 8000; i++) {    // about 8ms, a bit more because of the loop.
+        uint8_t status = usart->STATUS;
+        if (status & USART_BDF_bm) {            // left set for getStatus().
+          return SERIAL_AUTOBAUD_SYNC;
+        }
+        if (status & USART_ISFIF_bm) {          // getStatus() clears this, and deals with the errata.
+          return SERIAL_AUTOBAUD_BADSYNC;
+        }
+        delayMicroseconds(1);
+      }
+      return SERIAL_AUTOBAUD_ENABLED;
+    }
+
+    uint8_t HardwareSerial::autobaudWFB_and_wait(uint8_t n) {
+      uint8_t ret = autoBaudWFB();
+      while (n-- && ret == SERIAL_AUTOBAUD_ENABLED) {
+        ret = waitForSync();
+      }
+      return ret;
+    }
+
+    uint8_t HardwareSerial::autobaudWFB_and_request(uint8_t n) {
+      flush();                                  // Must not set WFB while we still have data going out at the old baud rate.
+      uint8_t ret = autoBaudWFB();
+      if (ret) {
+        while (n--) {
+          write((uint8_t) 0x00);                // The other side sees framing errors, and should reply with a sync.
+        }
+      }
+      return ret;
+    }
+
+    int16_t HardwareSerial::baudError() {
+      uint16_t current = _hwserial_module->BAUD;
+      if (!current || !_baud_nominal) {
+        return 0;
+      }
+      // BAUD is inversely proportional to the baud rate.
+      int32_t error = (((int32_t)_baud_nominal - current) * 10000) / current;
+      if (error > 32767) {
+        return 32767;
+      }
+      return (int16_t) error;                   // can't be below -10000.
+    }
+
+    void HardwareSerial::correctBaud(int16_t error) {
+      if (error <= -10000 || !_baud_nominal) {
+        return;
+      }
+      uint32_t setting = ((uint32_t)_baud_nominal * 10000UL) / (uint16_t)(10000 + error);
+      if (setting < 64) {
+        setting = 64;
+      } else if (setting > 0xFFFF) {
+        setting = 0xFFFF;
+      }
+      uint8_t oldSREG = SREG;
+      cli();
+      _hwserial_module->BAUD = (uint16_t) setting;
+      SREG = oldSREG;
+    }
+
+    uint32_t HardwareSerial::currentBaud() {
+      uint16_t current = _hwserial_module->BAUD;
+      if (!current) {
+        return 0;
+      }
+      uint32_t baud = (4 * F_CPU) / current;
+      if ((_hwserial_module->CTRLB & USART_RXMODE_gm) == USART_RXMODE_CLK2X_gc) {
+        baud <<= 1;
+      }
+      return baud;
+    }
+
     int HardwareSerial::available(void) {
-      return ((unsigned int)(SERIAL_RX_BUFFER_SIZE + _rx_buffer_head - _rx_buffer_tail)) & (SERIAL_RX_BUFFER_SIZE - 1);   //% SERIAL_RX_BUFFER_SIZE;
+      rx_buffer_index_t head;
+      RX_BUFFER_ATOMIC {
+        head = _rx_buffer_head;
+      }
+      return ((unsigned int)(head - _rx_buffer_tail)) & _rx_buffer_mask;
     }
 
     int HardwareSerial::peek(void) {
-      if (_rx_buffer_head == _rx_buffer_tail) {
+      rx_buffer_index_t head;
+      RX_BUFFER_ATOMIC {
+        head = _rx_buffer_head;
+      }
+      if (head == _rx_buffer_tail) {
         return -1;
       } else {
         return _rx_buffer[_rx_buffer_tail];
@@ -715,12 +1008,20 @@
     }
 
     int HardwareSerial::read(void) {
+      rx_buffer_index_t head;
+      rx_buffer_index_t tail = _rx_buffer_tail;
+      RX_BUFFER_ATOMIC {
+        head = _rx_buffer_head;
+      }
       // if the head isn't ahead of the tail, we don't have any characters
-      if (_rx_buffer_head == _rx_buffer_tail) {
+      if (head == tail) {
         return -1;
       } else {
-        unsigned char c = _rx_buffer[_rx_buffer_tail];
-        _rx_buffer_tail = (rx_buffer_index_t)(_rx_buffer_tail + 1) & (SERIAL_RX_BUFFER_SIZE - 1);   // % SERIAL_RX_BUFFER_SIZE;
+        unsigned char c = _rx_buffer[tail];
+        tail = (rx_buffer_index_t)(tail + 1) & _rx_buffer_mask;
+        RX_BUFFER_ATOMIC {
+          _rx_buffer_tail = tail;
+        }
         return c;
       }
     }
@@ -733,10 +1034,7 @@
           head = _tx_buffer_head;
           tail = _tx_buffer_tail;
         }
-        if (head >= tail) {
-          return SERIAL_TX_BUFFER_SIZE - 1 - head + tail;
-        }
-        return tail - head - 1;
+        return (tx_buffer_index_t)(tail - head - 1) & _tx_buffer_mask;
       }
 
       void HardwareSerial::flush() {
@@ -776,7 +1074,7 @@
         // to the data register and be done. This shortcut helps
         // significantly improve the effective data rate at high (>
         // 500kbit/s) bit rates, where interrupt overhead becomes a slowdown.
-        if ((_tx_buffer_head == _tx_buffer_tail) && ((*_hwserial_module).STATUS & USART_DREIF_bm)) {
+        if ((_tx_buffer_head == _tx_buffer_tail) && !writeBlockBusy() && ((*_hwserial_module).STATUS & USART_DREIF_bm)) {
           if (_state & 2) { // in half duplex mode, we turn off RXC interrupt
             uint8_t ctrla = (*_hwserial_module).CTRLA;
             ctrla &= ~USART_RXCIE_bm;
@@ -805,7 +1103,7 @@
            */
           return 1;
         }
-        tx_buffer_index_t i = (_tx_buffer_head + 1) & (SERIAL_TX_BUFFER_SIZE - 1);  // % SERIAL_TX_BUFFER_SIZE;
+        tx_buffer_index_t i = (_tx_buffer_head + 1) & _tx_buffer_mask;
 
         // If the output buffer is full, there's nothing we can do other than to
         // wait for the interrupt handler to empty it a bit (or emulate interrupts)
@@ -827,6 +1125,281 @@
         return 1;
       }
 
+      uint8_t * HardwareSerial::reserve(size_t n) {
+        uint16_t size = (uint16_t)_tx_buffer_mask + 1;
+        if (n == 0 || n >= size) {
+          return NULL;
+        }
+        tx_buffer_index_t head;
+        tx_buffer_index_t tail;
+        uint8_t oldSREG = SREG;
+        cli();
+        head = _tx_buffer_head;
+        if (head == _tx_buffer_tail) {          // If it's empty, start from the beginning, so we have the whole buffer without wrapping.
+          head = 0;                             // The DRE ISR only cares whether they're equal, and a block is sent before the ring.
+          _tx_buffer_head = 0;
+          _tx_buffer_tail = 0;
+        }
+        SREG = oldSREG;
+        // Only we move the head, so the space after it can only grow while we wait.
+        while (1) {
+          TX_BUFFER_ATOMIC {
+            tail = _tx_buffer_tail;
+          }
+          uint16_t room;
+          if (tail > head) {
+            room = tail - head - 1;
+          } else {
+            if (size - head < n) {
+              return NULL;                      // Won't fit before the end, no matter how long we wait.
+            }
+            room = size - head - (tail == 0 ? 1 : 0);
+          }
+          if (room >= n) {
+            break;
+          }
+          _poll_tx_data_empty();
+        }
+        _state |= 1;                            // Record that we have written to serial since it was begun.
+        return (uint8_t *)_tx_buffer + head;
+      }
+
+      void HardwareSerial::commit(size_t n) {
+        if (n == 0) {
+          return;
+        }
+        tx_buffer_index_t head = (_tx_buffer_head + n) & _tx_buffer_mask;
+        TX_BUFFER_ATOMIC {
+          _tx_buffer_head = head;
+        }
+        if (_state & 2) { // in half duplex mode, we turn off RXC interrupt, same as write().
+          uint8_t ctrla = (*_hwserial_module).CTRLA;
+          ctrla &= ~USART_RXCIE_bm;
+          ctrla |= USART_TXCIE_bm | USART_DREIE_bm;
+          (*_hwserial_module).STATUS = USART_TXCIF_bm;
+          (*_hwserial_module).CTRLA = ctrla;
+        } else {
+          (*_hwserial_module).CTRLA |= USART_DREIE_bm;
+        }
+      }
+
+      size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+        // Half the buffer at a time, so we can start filling it again while the first half is going out, instead of waiting for it to empty.
+        size_t chunk = ((uint16_t)_tx_buffer_mask + 1) >> 1;
+        size_t left = size;
+        while (left) {
+          size_t n = (left < chunk ? left : chunk);
+          uint8_t * dest = reserve(n);
+          if (dest) {
+            memcpy(dest, buffer, n);
+            commit(n);
+          } else {
+            n = write(*buffer);                 // At the end of the buffer - once we wrap, reserve() will work again.
+          }
+          buffer += n;
+          left   -= n;
+        }
+        return size;
+      }
+
+      size_t HardwareSerial::writeBlock(const uint8_t *buffer, size_t len, void (*callback)(void)) {
+        if (len == 0 || buffer == NULL) {
+          return 0;
+        }
+        // Anything already queued has to go out first, so that the order is preserved, since the DRE ISR always services a block before the ring.
+        // There can only be one block at a time; if there's one in progress already, we wait for it to finish, just like write() when the ring is full.
+        while (writeBlockBusy() || (_tx_buffer_head != _tx_buffer_tail)) {
+          _poll_tx_data_empty();
+        }
+        uint8_t oldSREG = SREG;
+        cli();
+        _state |= 1;              // Record that we have written to serial since it was begun, so flush() will wait for this.
+        _block_len      = len;
+        _block_callback = callback;
+        _block_ptr      = buffer; // Must be last - as soon as this is set, the ISR will consider the block valid.
+        uint8_t ctrla = (*_hwserial_module).CTRLA;
+        if (_state & 2) {         // in half duplex mode, we turn off RXC interrupt, exactly as write() does.
+          ctrla &= ~USART_RXCIE_bm;
+          ctrla |= USART_TXCIE_bm;
+        }
+        (*_hwserial_module).CTRLA = ctrla | USART_DREIE_bm;
+        SREG = oldSREG;
+        return len;
+      }
+
+    #if defined(SERIAL_FRAMED_RX)
+      void HardwareSerial::framedRx(int16_t delimiter, uint16_t maxFrame) {
+        uint16_t size = (uint16_t)_rx_buffer_mask + 1;
+        if (maxFrame == 0) {
+          maxFrame = size >> 1;
+        } else if (maxFrame > size - 1) {
+          maxFrame = size - 1;                  // one byte of the buffer is always unused, same as with a ring buffer.
+        }
+        uint8_t oldSREG = SREG;
+        cli();
+        _frame_delimiter = (uint8_t) delimiter;
+        _frame_max       = (rx_buffer_index_t) maxFrame;
+        _frame_q_head    = 0;
+        _frame_q_tail    = 0;
+        _frame_start     = 0;
+        _rx_buffer_head  = 0;
+        _rx_buffer_tail  = 0;
+        _frame_flags     = (delimiter < 0 ? SERIAL_FRAME_ON_bm : (SERIAL_FRAME_ON_bm | SERIAL_FRAME_DELIM_bm));
+        SREG = oldSREG;
+      }
+
+      void HardwareSerial::framedRxEnd() {
+        uint8_t oldSREG = SREG;
+        cli();
+        _frame_flags    = 0;
+        _rx_buffer_head = 0;
+        _rx_buffer_tail = 0;
+        _xact_buf       = NULL;                 // Abandon any transaction without calling back.
+        if (_frame_timer) {
+          _frame_timer->CTRLA   = 0;
+          _frame_timer->INTCTRL = 0;
+          _frame_timer = NULL;
+        }
+        SREG = oldSREG;
+      }
+
+      bool HardwareSerial::framedRxTimeout(TCB_t &timer, uint16_t microseconds) {
+        uint32_t ticks = microsecondsToClockCycles((uint32_t)microseconds) >> 1;
+        if (ticks > 0xFFFF) {
+          return false;
+        }
+        uint8_t oldSREG = SREG;
+        cli();
+        timer.CTRLA    = 0;
+        timer.INTCTRL  = 0;
+        _frame_timer   = NULL;
+        _xact_buf      = NULL;                  // can't time out a transaction without the timer.
+        if (ticks) {                            // 0 turns the timeout off.
+          timer.CTRLB    = TCB_CNTMODE_INT_gc;
+          timer.CCMP     = (uint16_t) ticks;
+          timer.CNT      = 0;
+          timer.INTFLAGS = TCB_CAPT_bm;
+          timer.INTCTRL  = TCB_CAPT_bm;
+          timer.CTRLA    = TCB_CLKSEL_DIV2_gc;  // Not enabled until a byte arrives.
+          _frame_timer   = &timer;
+        }
+        SREG = oldSREG;
+        return true;
+      }
+
+      uint16_t HardwareSerial::getFrame(uint8_t **data) {
+        uint8_t qtail = _frame_q_tail;
+        if (qtail == _frame_q_head) {
+          return 0;
+        }
+        *data = (uint8_t *)_rx_buffer + _frame_q[qtail].start;
+        return _frame_q[qtail].length;
+      }
+
+      void HardwareSerial::releaseFrame() {
+        uint8_t qtail = _frame_q_tail;
+        if (qtail != _frame_q_head) {
+          _frame_q_tail = (qtail + 1) & (SERIAL_FRAME_QUEUE_SIZE - 1); // Only we write this, and only the ISR writes the head, so no need for cli.
+        }
+      }
+
+      // Called from the RXC ISR when the delimiter arrives, and from the TCB ISR when the line goes idle.
+      void HardwareSerial::_frame_close(HardwareSerial& uartClass) {
+        uint8_t flags = uartClass._frame_flags;
+        rx_buffer_index_t head  = uartClass._rx_buffer_head;
+        rx_buffer_index_t start = uartClass._frame_start;
+        if (flags & SERIAL_FRAME_OPEN_bm) {
+          uint8_t qhead = uartClass._frame_q_head;
+          uint8_t qnext = (qhead + 1) & (SERIAL_FRAME_QUEUE_SIZE - 1);
+          if (!(flags & SERIAL_FRAME_DISCARD_bm) && uartClass._xact_buf) {
+            // This is the response to transact(). It doesn't go in the queue, since we copy it out now.
+            uint8_t * dest = uartClass._xact_buf;
+            volatile uint8_t * src = uartClass._rx_buffer + start;
+            uint16_t length = (rx_buffer_index_t)(head - start);
+            if (length > uartClass._xact_max) {
+              length = uartClass._xact_max;
+            }
+            for (uint16_t i = 0; i < length; i++) {
+              *dest++ = *src++;
+            }
+            head = start;
+            _xact_done(uartClass, length);
+          } else if (!(flags & SERIAL_FRAME_DISCARD_bm) && qnext != uartClass._frame_q_tail) {
+            uartClass._frame_q[qhead].start  = start;
+            uartClass._frame_q[qhead].length = head - start;
+            uartClass._frame_q_head = qnext;
+          } else {
+            head = start;                       // throw away what we got of it,
+            uartClass._state |= 0x40;           // and report it like any other lost data.
+          }
+        }
+        uartClass._rx_buffer_head = head;
+        uartClass._frame_start    = head;
+        uartClass._frame_flags    = flags & (SERIAL_FRAME_ON_bm | SERIAL_FRAME_DELIM_bm);
+      }
+
+      void HardwareSerial::_frame_timeout_irq(HardwareSerial& uartClass) {
+        TCB_t * timer = uartClass._frame_timer;
+        if (uartClass._frame_flags & SERIAL_FRAME_ON_bm) {
+          _frame_close(uartClass);              // this completes a transaction if there was one waiting for this frame.
+        }
+        if (timer) {
+          timer->INTFLAGS = TCB_CAPT_bm;
+          if (uartClass._xact_buf && --uartClass._xact_periods) {
+            return;                             // Still waiting for a response, so leave the timer running to count down the timeout.
+          }
+          timer->CTRLA   &= ~TCB_ENABLE_bm;     // stays off until the next byte.
+        }
+        if (uartClass._xact_buf) {
+          _xact_done(uartClass, 0);             // timed out
+        }
+      }
+
+      void HardwareSerial::_xact_done(HardwareSerial& uartClass, uint16_t length) {
+        uartClass._xact_result = length;
+        uartClass._xact_buf    = NULL;          // before the callback, so it can start the next transaction.
+        void (*callback)(uint16_t) = uartClass._xact_callback;
+        if (callback) {
+          callback(length);
+        }
+      }
+
+      bool HardwareSerial::transact(const uint8_t *request, uint16_t reqlen, uint8_t *response, uint16_t maxlen, uint16_t timeout, void (*callback)(uint16_t length)) {
+        TCB_t * timer = _frame_timer;
+        if (!(_frame_flags & SERIAL_FRAME_ON_bm) || !timer || _xact_buf || !request || !reqlen || !response || !maxlen) {
+          return false;
+        }
+        // The receiver has to be switched off while sending and back on when the last bit is out, so the TX side must be idle before
+        // we start. Otherwise the TXC at the end of whatever was already queued would turn it back on too early.
+        while (writeBlockBusy() || (_tx_buffer_head != _tx_buffer_tail)) {
+          _poll_tx_data_empty();
+        }
+        // the timeout is counted in periods of the frame timer, which runs at F_CPU/2.
+        uint32_t periods = ((uint32_t)timeout * (F_CPU / 2000UL)) / timer->CCMP + 1;
+        if (periods > 0xFFFF) {
+          periods = 0xFFFF;
+        }
+        uint8_t oldSREG = SREG;
+        cli();
+        _frame_q_tail   = _frame_q_head;        // Anything received before now isn't the response.
+        _frame_flags   &= (SERIAL_FRAME_ON_bm | SERIAL_FRAME_DELIM_bm);
+        _frame_start    = 0;
+        _rx_buffer_head = 0;
+        _xact_max       = maxlen;
+        _xact_callback  = callback;
+        _xact_periods   = (uint16_t) periods;
+        _xact_buf       = response;
+        volatile USART_t * usart = _hwserial_module;
+        // Exactly like half duplex mode: the TXC ISR throws away anything received while we were sending and turns RXC back on.
+        usart->CTRLA    = (usart->CTRLA & ~USART_RXCIE_bm) | USART_TXCIE_bm;
+        timer->CNT      = 0;
+        timer->CTRLA   |= TCB_ENABLE_bm;
+        writeBlock(request, reqlen);            // won't wait, since we know TX is idle; leaves interrupts disabled.
+        SREG = oldSREG;
+        return true;
+      }
+    #endif
+
       void HardwareSerial::printHex(const uint8_t b) {
         char x = (b >> 4) | '0';
         if (x > '9')
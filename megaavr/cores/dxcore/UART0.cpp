@@ -83,8 +83,7 @@
     }
   #endif
 
-  #if !(defined(USE_ASM_RXC) && (USE_ASM_RXC == 1 || USE_ASM_RXC == 2) && \
-       (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16) /* && defined(USART1)*/)
+  #if !(SERIAL_ASM_ISRS(SERIAL0_RX_BUFFER_SIZE, SERIAL0_TX_BUFFER_SIZE) & SERIAL_ASM_RXC_bm)
     ISR(USART0_RXC_vect) {
       HardwareSerial::_rx_complete_irq(Serial);
     }
@@ -105,9 +104,7 @@
         __builtin_unreachable();
     }
   #endif
-  #if !(defined(USE_ASM_DRE) && USE_ASM_DRE == 1 && \
-       (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16) && \
-       (SERIAL_TX_BUFFER_SIZE == 256 || SERIAL_TX_BUFFER_SIZE == 128 || SERIAL_TX_BUFFER_SIZE == 64 || SERIAL_TX_BUFFER_SIZE == 32 || SERIAL_TX_BUFFER_SIZE == 16))
+  #if !(SERIAL_ASM_ISRS(SERIAL0_RX_BUFFER_SIZE, SERIAL0_TX_BUFFER_SIZE) & SERIAL_ASM_DRE_bm)
     ISR(USART0_DRE_vect) {
       HardwareSerial::_tx_data_empty_irq(Serial);
     }
@@ -128,5 +125,9 @@
       __builtin_unreachable();
     }
   #endif
-  HardwareSerial Serial0(&USART0, (uint8_t*)_usart0_pins, MUXCOUNT_USART0, HWSERIAL0_MUX_DEFAULT);
+  static volatile uint8_t _serial0_rx_buffer[SERIAL0_RX_BUFFER_SIZE];
+  static volatile uint8_t _serial0_tx_buffer[SERIAL0_TX_BUFFER_SIZE];
+  HardwareSerial Serial0(&USART0, (uint8_t*)_usart0_pins, MUXCOUNT_USART0, HWSERIAL0_MUX_DEFAULT,
+                         _serial0_rx_buffer, SERIAL0_RX_BUFFER_SIZE, _serial0_tx_buffer, SERIAL0_TX_BUFFER_SIZE,
+                         SERIAL_ASM_ISRS(SERIAL0_RX_BUFFER_SIZE, SERIAL0_TX_BUFFER_SIZE));
 #endif
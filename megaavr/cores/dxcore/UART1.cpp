@@ -55,8 +55,7 @@
     }
   #endif
 
-  #if !(defined(USE_ASM_RXC) && (USE_ASM_RXC == 1 || USE_ASM_RXC == 2) && \
-      (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16))
+  #if !(SERIAL_ASM_ISRS(SERIAL1_RX_BUFFER_SIZE, SERIAL1_TX_BUFFER_SIZE) & SERIAL_ASM_RXC_bm)
     ISR(USART1_RXC_vect) {
       HardwareSerial::_rx_complete_irq(Serial1);
     }
@@ -77,9 +76,7 @@
         __builtin_unreachable();
     }
   #endif
-  #if !(defined(USE_ASM_DRE) && USE_ASM_DRE == 1 && \
-       (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16) && \
-       (SERIAL_TX_BUFFER_SIZE == 256 || SERIAL_TX_BUFFER_SIZE == 128 || SERIAL_TX_BUFFER_SIZE == 64 || SERIAL_TX_BUFFER_SIZE == 32 || SERIAL_TX_BUFFER_SIZE == 16))
+  #if !(SERIAL_ASM_ISRS(SERIAL1_RX_BUFFER_SIZE, SERIAL1_TX_BUFFER_SIZE) & SERIAL_ASM_DRE_bm)
     ISR(USART1_DRE_vect) {
       HardwareSerial::_tx_data_empty_irq(Serial1);
     }
@@ -100,5 +97,9 @@
       __builtin_unreachable();
     }
   #endif
-  HardwareSerial Serial1(&USART1, (uint8_t*)_usart1_pins, MUXCOUNT_USART1, HWSERIAL1_MUX_DEFAULT);
+  static volatile uint8_t _serial1_rx_buffer[SERIAL1_RX_BUFFER_SIZE];
+  static volatile uint8_t _serial1_tx_buffer[SERIAL1_TX_BUFFER_SIZE];
+  HardwareSerial Serial1(&USART1, (uint8_t*)_usart1_pins, MUXCOUNT_USART1, HWSERIAL1_MUX_DEFAULT,
+                         _serial1_rx_buffer, SERIAL1_RX_BUFFER_SIZE, _serial1_tx_buffer, SERIAL1_TX_BUFFER_SIZE,
+                         SERIAL_ASM_ISRS(SERIAL1_RX_BUFFER_SIZE, SERIAL1_TX_BUFFER_SIZE));
 #endif  // HWSERIAL1
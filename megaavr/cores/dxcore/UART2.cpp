@@ -59,8 +59,7 @@
     }
   #endif
 
-  #if !(defined(USE_ASM_RXC) && (USE_ASM_RXC == 1 || USE_ASM_RXC == 2) && \
-    (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16))
+  #if !(SERIAL_ASM_ISRS(SERIAL2_RX_BUFFER_SIZE, SERIAL2_TX_BUFFER_SIZE) & SERIAL_ASM_RXC_bm)
     ISR(USART2_RXC_vect) {
       HardwareSerial::_rx_complete_irq(Serial2);
     }
@@ -81,9 +80,7 @@
         __builtin_unreachable();
     }
   #endif
-  #if !(defined(USE_ASM_DRE) && USE_ASM_DRE == 1 && \
-       (SERIAL_RX_BUFFER_SIZE == 256 || SERIAL_RX_BUFFER_SIZE == 128 || SERIAL_RX_BUFFER_SIZE == 64 || SERIAL_RX_BUFFER_SIZE == 32 || SERIAL_RX_BUFFER_SIZE == 16) && \
-       (SERIAL_TX_BUFFER_SIZE == 256 || SERIAL_TX_BUFFER_SIZE == 128 || SERIAL_TX_BUFFER_SIZE == 64 || SERIAL_TX_BUFFER_SIZE == 32 || SERIAL_TX_BUFFER_SIZE == 16))
+  #if !(SERIAL_ASM_ISRS(SERIAL2_RX_BUFFER_SIZE, SERIAL2_TX_BUFFER_SIZE) & SERIAL_ASM_DRE_bm)
     ISR(USART2_DRE_vect) {
       HardwareSerial::_tx_data_empty_irq(Serial2);
     }
@@ -104,5 +101,9 @@
       __builtin_unreachable();
     }
   #endif
-  HardwareSerial Serial2(&USART2, (uint8_t*)_usart2_pins, MUXCOUNT_USART2, HWSERIAL2_MUX_DEFAULT);
+  static volatile uint8_t _serial2_rx_buffer[SERIAL2_RX_BUFFER_SIZE];
+  static volatile uint8_t _serial2_tx_buffer[SERIAL2_TX_BUFFER_SIZE];
+  HardwareSerial Serial2(&USART2, (uint8_t*)_usart2_pins, MUXCOUNT_USART2, HWSERIAL2_MUX_DEFAULT,
+                         _serial2_rx_buffer, SERIAL2_RX_BUFFER_SIZE, _serial2_tx_buffer, SERIAL2_TX_BUFFER_SIZE,
+                         SERIAL_ASM_ISRS(SERIAL2_RX_BUFFER_SIZE, SERIAL2_TX_BUFFER_SIZE));
 #endif
@@ -131,7 +131,8 @@
 
 #define SERIAL_AUTOBAUD                     (0x80000000) // OR with baud rate for topology 3 in Ref. Serial
 #define SERIAL_REQUIRE_AUTOBAUD             (0xFFFFFFFF) // Specify autobaud... plus an obscenely fast baud rate. The other device must send a sync frame. Good for slaves in topology 2, or in topology 1
-#define SERIAL_MAKE_AUTOBAUD(intial_baud)   ((__asm__ __volatile__ ("ori %D0, 0x80" "\n\t" : "+d" (uint32_t)(initial_baud))), initial_baud) // Like ORing the baud rate, only faster, if it works;
+#define SERIAL_DEMAND_AUTOBAUD              SERIAL_REQUIRE_AUTOBAUD // The name used in the documentation.
+#define SERIAL_MAKE_AUTOBAUD(initial_baud)  (((uint32_t)(initial_baud)) | SERIAL_AUTOBAUD) // Same as ORing it yourself. The compiler folds the constant.
 
 #define SERIAL_AUTOBAUD_DISABLED    0x00
 
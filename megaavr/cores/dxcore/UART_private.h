@@ -16,8 +16,17 @@
 
 // Constructor
 // no need to set the other variables to zero, init script already does that. Saves some flash
-HardwareSerial::HardwareSerial(volatile USART_t *hwserial_module, uint8_t *usart_pins, uint8_t mux_count, uint8_t mux_default) :
-    _hwserial_module(hwserial_module), _usart_pins(usart_pins), _mux_count(mux_count), _pin_set(mux_default) {
+// The sizes are compile time constants from the SERIALn_xX_BUFFER_SIZE defines, so the masks get computed by the compiler.
+HardwareSerial::HardwareSerial(volatile USART_t *hwserial_module, uint8_t *usart_pins, uint8_t mux_count, uint8_t mux_default,
+                               volatile uint8_t *rx_buffer, uint16_t rx_size, volatile uint8_t *tx_buffer, uint16_t tx_size, uint8_t asm_isrs) :
+    _hwserial_module(hwserial_module), _usart_pins(usart_pins), _mux_count(mux_count), _pin_set(mux_default),
+    _rx_buffer_mask((rx_buffer_index_t)(rx_size - 1)), _tx_buffer_mask((tx_buffer_index_t)(tx_size - 1)),
+    _rx_buffer(rx_buffer), _tx_buffer(tx_buffer) {
+  #if defined(SERIAL_RX_INDEX_16BIT) || defined(SERIAL_TX_INDEX_16BIT)
+    _asm_isrs = asm_isrs;     // Only needed when some ports may be using the C ISRs while others use the asm ones.
+  #else
+    (void) asm_isrs;
+  #endif
 }
 
 #endif  // whole file
@@ -41,17 +41,26 @@ size_t Print::write(const uint8_t *buffer, size_t size) {
 size_t Print::print(const __FlashStringHelper *ifsh) {
   #if defined(__AVR__)
   PGM_P p = reinterpret_cast<PGM_P>(ifsh);
+  size_t len = strlen_P(p);
+  uint8_t *dest = reserve(len);
+  if (dest) {
+    memcpy_P(dest, p, len);
+    commit(len);
+    return len;
+  }
+  // Otherwise copy it out in chunks, so a target that overrides write(buffer, size) still gets more than one byte at a time.
+  uint8_t buf[16];
   size_t n = 0;
-  while (1) {
-    unsigned char c = pgm_read_byte(p++);
-    if (c == 0) {
-      break;
-    }
-    if (write(c)) {
-      n++;
-    } else {
+  while (len) {
+    uint8_t chunk = len > sizeof(buf) ? sizeof(buf) : len;
+    memcpy_P(buf, p, chunk);
+    size_t written = write(buf, chunk);
+    n += written;
+    if (written != chunk) {
       break;
     }
+    p   += chunk;
+    len -= chunk;
   }
   return n;
   #else
@@ -230,7 +239,7 @@ size_t Print::printNumber(unsigned long n, uint8_t base) {
     *--str = c < 10 ? c + '0' : c + 'A' - 10;
   } while (n);
 
-  return write(str);
+  return write(str, &buf[sizeof(buf) - 1] - str); // we know the length, and a buffered target can take it in one go.
 }
 
 size_t Print::printFloat(double number, uint8_t digits) {
@@ -273,12 +282,18 @@ size_t Print::printFloat(double number, uint8_t digits) {
     n += print(".");
   }
 
-  // Extract digits from the remainder one at a time
+  // Extract digits from the remainder one at a time, collecting them so they can be written together
+  char buf[16];
+  uint8_t len = 0;
   while (digits-- > 0) {
     remainder *= 10.0;
     unsigned int toPrint = (unsigned int)remainder;
-    n += print(toPrint);
+    buf[len++] = '0' + toPrint;
     remainder -= toPrint;
+    if (len == sizeof(buf) || digits == 0) {
+      n += write(buf, len);
+      len = 0;
+    }
   }
 
   return n;
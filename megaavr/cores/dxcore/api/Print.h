@@ -64,6 +64,12 @@ class Print {
     // should be overridden by subclasses with buffering
     virtual int availableForWrite() { return 0; }
 
+    // Buffered targets can let print() format straight into their buffer instead of going through write() one byte at a time.
+    // reserve(n) returns a pointer to n contiguous bytes of buffer space, or NULL (the default) if it can't, in which case the
+    // data goes through write() instead. A successful reserve() must be followed by commit() of the number of bytes used.
+    virtual uint8_t * reserve(size_t n) { (void) n; return NULL; }
+    virtual void commit(size_t n) { (void) n; }
+
     size_t print(const __FlashStringHelper *);
     size_t print(const String &);
     size_t print(const char[]);
@@ -44,6 +44,7 @@ int Stream::timedRead() {
       if (c >= 0) {
         return c;
       }
+      yield();   // Let a cooperative scheduler run something else while we wait.
     } while (millis() - startMillis < _timeout);
     return -1;     // -1 indicates timeout
   #else
@@ -69,6 +70,7 @@ int Stream::timedPeek() {
       if (c >= 0) {
         return c;
       }
+      yield();
     } while (millis() - startMillis < _timeout);
     return -1;     // -1 indicates timeout
   #else
@@ -79,6 +79,8 @@ uint8_t __attribute__((weak)) onAfterInit() {return 0;} // Called between init()
 #endif
 
 int main()  __attribute__((weak));
+/* Defined in wiring_timers.c, which is only linked in if a software timer is started. Otherwise this is NULL. */
+extern "C" void _runTimers() __attribute__((weak));
 /* The main function - call initialization functions (in wiring.c) then setup, and finally loop *
  * repeatedly. If SerialEvent is enabled (which should be unusual, as it is no longer a menu    *
  * option even, that gets checked for after each call to loop). Note that _pre_main() is        *
@@ -95,6 +97,9 @@ int main() {
   setup();
   for (;;) {
     loop();
+    if (_runTimers) {
+      _runTimers();
+    }
   }
 }
 
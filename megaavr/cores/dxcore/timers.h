@@ -67,6 +67,36 @@
 #define TIME_TRACKING_TICKS_PER_OVF   (TIME_TRACKING_TIMER_PERIOD   + 1UL)
 #define TIME_TRACKING_CYCLES_PER_OVF  (TIME_TRACKING_TICKS_PER_OVF  * TIME_TRACKING_TIMER_DIVIDER)
 
+/* Tickless millis: the TCB is clocked from TCA0's prescaled clock, and instead of interrupting every millisecond, it only
+ * interrupts when the 16-bit count runs out, or when something has asked to be woken up. The prescaler here must match
+ * what init_TCA0() uses. All of these give a whole number of ticks per second, which the timekeeping depends on. */
+#if defined(MILLIS_TICKLESS)
+  #if !defined(MILLIS_USE_TCB)
+    #error "MILLIS_TICKLESS requires a type B timer to be selected as the millis timer"
+  #endif
+  #if !defined(TCA0)
+    #error "MILLIS_TICKLESS clocks the millis timer from TCA0, which this part does not have"
+  #endif
+  #if   (F_CPU > 30000000UL)
+    #define TICKLESS_TIMER_DIVIDER        (256)
+    #define TICKLESS_TCA_CLKSEL           (TCA_SPLIT_CLKSEL_DIV256_gc)
+  #elif (F_CPU > 5000000UL)
+    #define TICKLESS_TIMER_DIVIDER        (64)
+    #define TICKLESS_TCA_CLKSEL           (TCA_SPLIT_CLKSEL_DIV64_gc)
+  #elif (F_CPU > 1000000UL)
+    #define TICKLESS_TIMER_DIVIDER        (16)
+    #define TICKLESS_TCA_CLKSEL           (TCA_SPLIT_CLKSEL_DIV16_gc)
+  #else
+    #define TICKLESS_TIMER_DIVIDER        (8)
+    #define TICKLESS_TCA_CLKSEL           (TCA_SPLIT_CLKSEL_DIV8_gc)
+  #endif
+  #define TICKLESS_TICKS_PER_SECOND       (F_CPU / TICKLESS_TIMER_DIVIDER)
+  /* Never set CCMP closer than this to CNT, or the count could pass it before the write lands. It must cover the most
+   * clocks that can go by between reading CNT and writing CCMP (with interrupts off), rounded up to whole ticks, plus one. */
+  #define TICKLESS_MAX_UPDATE_CYCLES      (64)
+  #define TICKLESS_MIN_TICKS              (TICKLESS_MAX_UPDATE_CYCLES / TICKLESS_TIMER_DIVIDER + 1)
+#endif
+
 // For a type B timer as millis, these #defines aren't needed, but they're defined accurately anyway,
 
 
@@ -106,7 +106,12 @@ void init_timers();
   #define MILLIS_INC (millisClockCyclesToMicroseconds(TIME_TRACKING_CYCLES_PER_OVF)/1000)
 
   struct sTimeMillis {
-    #if defined(MILLIS_USE_TCB)     // Now TCB as millis source does not need fraction
+    #if defined(MILLIS_TICKLESS)    // Tickless: timer_millis only changes once a second, the rest is worked out from ticks.
+      volatile uint32_t timer_millis;   // millis() at the start of the current second.
+      volatile uint32_t timer_subsec;   // ticks from the start of the current second to the start of the current timer period
+      volatile uint32_t wake_micros;    // someone wants an interrupt by the time micros() gets here...
+      volatile uint8_t  wake_pending;   // ... if this is set.
+    #elif defined(MILLIS_USE_TCB)     // Now TCB as millis source does not need fraction
       volatile uint32_t timer_millis;   // That's all we need to track here
 
     #elif defined(MILLIS_USE_TIMERRTC)  // RTC
@@ -130,6 +135,80 @@ void init_timers();
       }
       RTC.INTFLAGS = RTC_OVF_bm | RTC_CMP_bm; // clear flag
     }
+  #elif defined(MILLIS_TICKLESS)
+    /* Returns the number of ticks since the start of the current second, with interrupts already disabled. If the period
+     * has ended but the ISR hasn't run yet, the counter has already been reset, so we add the length of the period that
+     * ended. Reading the flag on both sides of CNT tells us whether the CNT we read was from before or after that reset. */
+    static uint32_t _tickless_subsec() {
+      uint8_t  flags = _timer->INTFLAGS;
+      uint16_t cnt   = _timer->CNT;
+      uint8_t  flags2 = _timer->INTFLAGS;
+      if (flags != flags2) {
+        cnt = _timer->CNT;
+      }
+      uint32_t s = timingStruct.timer_subsec + cnt;
+      if (flags2 & TCB_CAPT_bm) {
+        s += _timer->CCMP + 1UL;
+      }
+      return s;
+    }
+    static inline uint32_t _tickless_to_micros(uint32_t s) {
+      return (s * TICKLESS_TIMER_DIVIDER) / (F_CPU / 1000000UL);
+    }
+    /* How many ticks it will take for micros() to reach wake_micros from now_us, rounded up, or 0 if it already has.
+     * Anything past the longest possible period comes back as 0x10000, which just means "as long as you can" */
+    static uint32_t _tickless_ticks_until(uint32_t now_us) {
+      int32_t remaining = timingStruct.wake_micros - now_us;
+      if (remaining <= 0) {
+        return 0;
+      }
+      if ((uint32_t)remaining >= (0x10000UL * TICKLESS_TIMER_DIVIDER) / (F_CPU / 1000000UL)) {
+        return 0x10000;
+      }
+      return ((uint32_t)remaining * (F_CPU / 1000000UL) + TICKLESS_TIMER_DIVIDER - 1) / TICKLESS_TIMER_DIVIDER;
+    }
+    /* Make top the end of the current period, or the soonest point after it that we can still be sure of catching. CCMP must
+     * never end up behind CNT: the count would run on to 0xFFFF and wrap before matching, and the ISR, which only adds
+     * CCMP + 1, would lose 65536 ticks. So once it's written, we look at CNT again, and if the count got there first, we
+     * move it on. Interrupts must be disabled. */
+    static void _tickless_set_top(uint32_t top) {
+      uint16_t cnt = _timer->CNT;
+      while (1) {
+        if (top < (uint32_t)cnt + TICKLESS_MIN_TICKS) {
+          top = (uint32_t)cnt + TICKLESS_MIN_TICKS;
+        }
+        if (top > 0xFFFF) {
+          top = 0xFFFF;
+        }
+        _timer->CCMP = top;
+        cnt = _timer->CNT;
+        if (cnt <= top || (_timer->INTFLAGS & TCB_CAPT_bm)) {
+          return;
+        }
+      }
+    }
+    /* The timer has just reset to 0 (it may have counted a few ticks since). Pick how long this period will be. */
+    static void _tickless_schedule() {
+      uint32_t period = 0x10000;
+      if (timingStruct.wake_pending) {
+        period = _tickless_ticks_until(timingStruct.timer_millis * 1000 + _tickless_to_micros(timingStruct.timer_subsec));
+        if (period == 0) {
+          timingStruct.wake_pending = 0; // We're awake now, which is all they wanted.
+          period = 0x10000;
+        }
+      }
+      _tickless_set_top(period - 1);
+    }
+    ISR(MILLIS_VECTOR) {
+      _timer->INTFLAGS = TCB_CAPT_bm;
+      uint32_t s = timingStruct.timer_subsec + _timer->CCMP + 1UL;
+      if (s >= TICKLESS_TICKS_PER_SECOND) { // Periods are at most 65536 ticks, and a second is always more than that, so this can only happen once.
+        s -= TICKLESS_TICKS_PER_SECOND;
+        timingStruct.timer_millis += 1000;
+      }
+      timingStruct.timer_subsec = s;
+      _tickless_schedule();
+    }
   #elif !defined(MILLIS_USE_TIMERNONE)
     ISR(MILLIS_VECTOR, ISR_NAKED) {
       __asm__ __volatile__(
@@ -429,6 +508,11 @@ void init_timers();
         : "+r" (m), "+r" (temp), "+d" (cnt)
         );
       */
+    #elif defined(MILLIS_TICKLESS)
+      uint32_t s = _tickless_subsec();
+      m = timingStruct.timer_millis;
+      SREG = oldSREG;
+      m += (s * 1000) / TICKLESS_TICKS_PER_SECOND;
     #else
       m = timingStruct.timer_millis;
       SREG = oldSREG;
@@ -436,7 +520,18 @@ void init_timers();
     return m;
   }
 
-  #if !defined(MILLIS_USE_TIMERRTC)
+  #if defined(MILLIS_TICKLESS)
+    /* Same semantics as ever, but the resolution is one tick of TCA0's prescaled clock - 2.67 us at 24 MHz - and it costs a
+     * 32-bit division, as does millis(). That's the price of not taking an interrupt every millisecond. */
+    unsigned long micros() {
+      uint8_t oldSREG = SREG;
+      cli();
+      uint32_t s = _tickless_subsec();
+      uint32_t m = timingStruct.timer_millis;
+      SREG = oldSREG;
+      return m * 1000 + _tickless_to_micros(s);
+    }
+  #elif !defined(MILLIS_USE_TIMERRTC)
     unsigned long micros() {
       uint32_t overflows, microseconds;
       #if (defined(MILLIS_USE_TCD) || defined(MILLIS_USE_TCB))
@@ -1094,19 +1189,44 @@ void init_timers();
  *  1% on a good day. It matters greatly when you call delay(1);    */
 
 
-#if (!(defined(MILLIS_USE_TIMERNONE) || defined(MILLIS_USE_TIMERRTC) || (F_CPU == 7000000L || F_CPU == 14000000)))
+// Software timers are run while we wait - if there are any. This is NULL unless wiring_timers.c was linked in.
+void _runTimers() __attribute__((weak));
+
+#if defined(MILLIS_TICKLESS)
+  // Tickless: sleep (idle) until the delay is over, or an interrupt wakes us up. In 1 second chunks, to keep the math simple.
+  void delay(unsigned long ms)
+  {
+    uint32_t end = micros();
+    while (ms > 0) {
+      uint16_t chunk = (ms > 1000 ? 1000 : (uint16_t) ms);
+      end += chunk * 1000UL;
+      ms -= chunk;
+      while ((int32_t)(micros() - end) < 0) {
+        yield();
+        if (_runTimers) {
+          _runTimers();
+        }
+        idle_until_micros(end);
+      }
+    }
+  }
+#elif (!(defined(MILLIS_USE_TIMERNONE) || defined(MILLIS_USE_TIMERRTC) || (F_CPU == 7000000L || F_CPU == 14000000)))
   // delay implementation when we do have micros() - we know it won't work at 7 or 14, and those can be generated
   // from internal, and switch logic is in even though micros isn't.
   void delay(unsigned long ms)
   {
-    uint16_t start = (uint16_t)micros();
-    while (true) {
-      if (ms == 0) break;
+    // 32 bits, since a yield() that switches to another task may not come back for longer than 16 bits of us would cover.
+    uint32_t start = micros();
+    while (ms > 0) {
       yield();
-      uint16_t us_passed = (uint16_t)micros() - start;
-      if (us_passed >= 1000) {
+      if (_runTimers) {
+        _runTimers();
+      }
+      uint32_t us_passed = micros() - start;
+      while (us_passed >= 1000 && ms > 0) {
         ms--;
         start += 1000;
+        us_passed -= 1000;
       }
     }
   }
@@ -1796,6 +1916,15 @@ void __attribute__((weak)) init_millis()
         RTC.INTCTRL         = 0x01; // enable overflow interrupt
         RTC.CTRLA           = (RTC_RUNSTDBY_bm|RTC_RTCEN_bm|RTC_PRESCALER_DIV32_gc);//fire it up, prescale by 32.
       */
+    #elif defined(MILLIS_TICKLESS)
+      timingStruct.wake_pending = 0;
+      _timer->CTRLA = 0;
+      _timer->CTRLB = 0;            // Periodic interrupt mode - CCMP is TOP
+      _timer->CNT = 0;
+      _timer->CCMP = 0xFFFF;        // Nothing to wake up for yet
+      _timer->INTFLAGS = TCB_CAPT_bm;
+      _timer->INTCTRL = TCB_CAPT_bm;
+      _timer->CTRLA = TCB_CLKSEL_TCA0_gc | TCB_ENABLE_bm;
     #else // It's a type b timer - we have already errored out if that wasn't defined
       _timer->CCMP = TIME_TRACKING_TIMER_PERIOD;
       // Enable timer interrupt, but clear the rest of register
@@ -1854,7 +1983,17 @@ void set_millis(__attribute__((unused))uint32_t newmillis)
        * so this won't cause any desynchronization of timing for the vast majority of users.
        * -SK 2/4/23
        */
-      timingStruct.timer_millis = newmillis;
+      #if defined(MILLIS_TICKLESS)
+        uint8_t oldSREG = SREG;
+        cli();
+        _timer->CNT = 0;            // Start a fresh period from newmillis. The next ISR will reschedule any pending wake.
+        _timer->INTFLAGS = TCB_CAPT_bm;
+        timingStruct.timer_subsec = 0;
+        timingStruct.timer_millis = newmillis;
+        SREG = oldSREG;
+      #else
+        timingStruct.timer_millis = newmillis;
+      #endif
     //#endif
   #endif
 }
@@ -1874,6 +2013,62 @@ void nudge_millis(__attribute__((unused)) uint16_t nudgesize) {
   #endif
 }
 
+/* Ask for the millis timer to interrupt - and so wake the chip if it is sleeping - no later than when micros() reaches us,
+ * which must be within the next half hour or so. Only one wake time is kept; if an earlier one is already pending, this
+ * does nothing, since the caller will be woken up early and can ask again. Without MILLIS_TICKLESS the timer interrupts
+ * every millisecond regardless, so this does nothing. */
+void wake_at_micros(__attribute__((unused)) uint32_t us) {
+  #if defined(MILLIS_TICKLESS)
+    uint8_t oldSREG = SREG;
+    cli();
+    if (!timingStruct.wake_pending || (int32_t)(us - timingStruct.wake_micros) < 0) {
+      timingStruct.wake_micros  = us;
+      timingStruct.wake_pending = 1;
+      if (!(_timer->INTFLAGS & TCB_CAPT_bm)) { // If the period has just ended, the ISR will schedule the wake when we return.
+        uint16_t cnt = _timer->CNT;
+        uint32_t ticks = _tickless_ticks_until(timingStruct.timer_millis * 1000 + _tickless_to_micros(timingStruct.timer_subsec + cnt));
+        if (ticks) {
+          uint32_t target = (uint32_t)cnt + ticks - 1;
+          cnt = _timer->CNT;                   // That took a while, so see where it's got to now.
+          if (target < (uint32_t)cnt + TICKLESS_MIN_TICKS) {
+            target = (uint32_t)cnt + TICKLESS_MIN_TICKS;
+          }
+          /* Only move the end of the period closer, and only while it's still far enough off that it can't be reached
+           * before we've moved it - which target < CCMP guarantees, since target is at least TICKLESS_MIN_TICKS ahead. */
+          if (target < _timer->CCMP && !(_timer->INTFLAGS & TCB_CAPT_bm)) {
+            _tickless_set_top(target);
+          }
+        }
+      }
+    }
+    SREG = oldSREG;
+  #endif
+}
+
+/* Idle sleep until micros() reaches us, or any interrupt occurs, whichever is first. Returns immediately if interrupts are
+ * disabled, since nothing could wake us. */
+void idle_until_micros(__attribute__((unused)) uint32_t us) {
+  #if defined(MILLIS_USE_TIMERNONE)
+    badCall("idle_until_micros() needs millis timekeeping to be enabled.");
+  #else
+    uint8_t oldSREG = SREG;
+    if (!(oldSREG & CPU_I_bm)) {
+      return;
+    }
+    wake_at_micros(us);
+    cli();
+    if ((int32_t)(micros() - us) < 0) {
+      uint8_t sleepctrl = SLPCTRL.CTRLA;
+      SLPCTRL.CTRLA = SLPCTRL_SMODE_IDLE_gc | SLPCTRL_SEN_bm;
+      __asm__ __volatile__("sei"    "\n\t" // The instruction after sei is always executed before any interrupt, so
+                           "sleep"  "\n\t" // if the wake interrupt is due now, it can't sneak in before we sleep.
+                           ::);
+      SLPCTRL.CTRLA = sleepctrl;
+    }
+    SREG = oldSREG;
+  #endif
+}
+
 /********************************* ADC ****************************************/
 /* ADC versions:
  * t1/0/m0 - "1.0"      10-bit, single ended. 1-series w/16k+ have 2 of them.
@@ -344,7 +344,53 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
  * analogIsError(int16_t from analogRead or int32_t from analogReadEnh)
  *   Returns 1 (true) if the value, assuming it came from an analogRead/Enh
  *   function call, is not an analog reading but instead an error code.
+ *
+ *----------------------------------------------------------------------------
+ * Non-blocking reads:
+ * int16_t analogReadStart(uint8_t pin)
+ * int32_t analogReadEnhStart(uint8_t pin, uint8_t res, uint8_t gain)
+ * int32_t analogReadDiffStart(uint8_t pos, uint8_t neg, uint8_t res, uint8_t gain)
+ *     Check the arguments and start the conversion just like analogRead(),
+ *     analogReadEnh() and analogReadDiff() do, but return without waiting.
+ *     Return 0 if the conversion was started, otherwise the same error that
+ *     the blocking version would have returned. Until the result has been
+ *     collected, any other read will return ADC_ERROR_BUSY or
+ *     ADC_ENH_ERROR_BUSY.
+ * bool analogReadReady()
+ *     True if the result of the conversion is ready, so that
+ *     analogReadResult() or analogReadEnhResult() will not have to wait.
+ *     Also true if no conversion has been started.
+ * int16_t analogReadResult()
+ * int32_t analogReadEnhResult()
+ *     Wait for the conversion if it's not done yet, and return the result,
+ *     processed just as the blocking version would. analogReadResult() is
+ *     for analogReadStart(), and analogReadEnhResult() is for both
+ *     analogReadEnhStart() and analogReadDiffStart(). Return ADC_ERROR_BUSY
+ *     or ADC_ENH_ERROR_BUSY if no such conversion was started.
  ****************************************************************************/
+
+/* What conversion, if any, has been started and not yet collected. 0 means none; ANALOG_PENDING_READ is a plain analogRead(),
+ * and any other value is the res argument of an analogReadEnh() or analogReadDiff(), which we need to process the result. */
+#define ANALOG_PENDING_READ 0xFF
+static uint8_t _analog_pending = 0;
+
+bool analogReadReady() {
+  return (!_analog_pending) || (ADC0.INTFLAGS & ADC_RESRDY_bm);
+}
+
+/* True from a start function until the result is collected. Anything else that takes over the ADC (the ADCStream library,
+ * analogWindowStart()) must check this first, or the result that was asked for is lost. */
+bool analogReadPending() {
+  return _analog_pending != 0;
+}
+
+/* Set by analogSetCorrection(), normally from the ADCCalibration library. NULL means results are returned as they are. */
+static analogCorrectionFuncPtr _analog_correction = NULL;
+
+void analogSetCorrection(analogCorrectionFuncPtr correction) {
+  _analog_correction = correction;
+}
+
 #if defined(ADC0_TEMP2)  /* IMPORTANT IFDEF START NEW GOOD ADC */
     /*######    ###          ## ######## ########        ## ########  ######
     ##         ## ##        ##  ##       ##     ##      ##  ##       ##    ##           ##
@@ -403,7 +449,7 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     return _adcref_to_c(r); //convert native representation back into compound representation containing the settinf for both AC and ADC so that we don't have two sets of constants that need to be used depending on
   }
 /* Ex Version*/
-  int16_t analogRead(uint8_t pin) {
+  int16_t analogReadStart(uint8_t pin) {
     check_valid_analog_pin(pin);
     if (pin < 0x80) {
       // If high bit set, it's a channel, otherwise it's a digital pin so we look it up..
@@ -418,9 +464,9 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     #endif
       return ADC_ERROR_BAD_PIN_OR_CHANNEL;
     }
-    if (!ADC0.CTRLA & 0x01) return ADC_ERROR_DISABLED;
+    if (!(ADC0.CTRLA & 0x01)) return ADC_ERROR_DISABLED;
 
-    if (ADC0.COMMAND & ADC_START_gm) return ADC_ERROR_BUSY;
+    if ((ADC0.COMMAND & ADC_START_gm) || _analog_pending) return ADC_ERROR_BUSY;
     // gotta be careful here - don't want to shit ongoing conversion - unlikle classic AVRs
     // they say there is no buffering here!
     /* Select channel */
@@ -428,16 +474,31 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     uint8_t command = (_analog_options & 0x0F) > 8 ? 0x11 : 0x01;
     /* Start conversion */
     ADC0.COMMAND = command;
+    _analog_pending = ANALOG_PENDING_READ;
+    return 0;
+  }
 
+  int16_t analogReadResult() {
+    if (_analog_pending != ANALOG_PENDING_READ) return ADC_ERROR_BUSY;
     /* Wait for result ready */
     while (!(ADC0.INTFLAGS & ADC_RESRDY_bm));
+    _analog_pending = 0;
+    int16_t result = ADC0.RESULT;
     // if it's 10 bit compatibility mode, have to rightshift twice.
     if ((_analog_options & 0x0F) == 10) {
-      int16_t temp = ADC0.RESULT;
-      temp >>= 2;
-      return temp;
+      result >>= 2;
     }
-    return ADC0.RESULT;
+    if (_analog_correction) {
+      result = _analog_correction(result, _analog_options & 0x0F, false);
+    }
+    return result;
+  }
+
+  int16_t analogRead(uint8_t pin) {
+    check_valid_analog_pin(pin);
+    int16_t err = analogReadStart(pin);
+    if (err) return err;
+    return analogReadResult();
   }
 
 /* Ex Version*/
@@ -522,7 +583,7 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
   }
 
 /* Ex Version*/
-  int32_t _analogReadEnh(uint8_t pin, uint8_t neg, uint8_t res, uint8_t gain) {
+  int32_t _analogReadEnhStart(uint8_t pin, uint8_t neg, uint8_t res, uint8_t gain) {
     if (!(ADC0.CTRLA & 0x01)) {return ADC_ENH_ERROR_DISABLED;}
     uint8_t sampnum;
     if (res > 0x80) { // raw accumulation
@@ -569,7 +630,7 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     }
     pin &= 0x3F;
 
-    if (ADC0.COMMAND & ADC_START_gm) return ADC_ENH_ERROR_BUSY;
+    if ((ADC0.COMMAND & ADC_START_gm) || _analog_pending) return ADC_ENH_ERROR_BUSY;
     if (gain != 0) {
       uint8_t gainbits = 0;
       while (gain > 1) {
@@ -586,7 +647,15 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     ADC0.CTRLF = sampnum;
     uint8_t command = ((neg != SINGLE_ENDED)?0x80:0) | ((res == 8) ? ADC_MODE_SINGLE_8BIT_gc : (res > ADC_NATIVE_RESOLUTION ? ADC_MODE_BURST_gc : ADC_MODE_SINGLE_12BIT_gc)) | 1;
     ADC0.COMMAND = command;
+    _analog_pending = res;
+    return 0;
+  }
+
+  int32_t analogReadEnhResult() {
+    uint8_t res = _analog_pending;
+    if (res == 0 || res == ANALOG_PENDING_READ) return ADC_ENH_ERROR_BUSY;
     while (!(ADC0.INTFLAGS & ADC_RESRDY_bm));
+    _analog_pending = 0;
     int32_t result = ADC0.RESULT;
 
     if (res < 0x80 && res > ADC_NATIVE_RESOLUTION) {
@@ -610,8 +679,40 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     if (_analog_options & 0x80) { // this bit controls autoshutoff of PGA.
       ADC0.PGACTRL &= ~ADC_PGAEN_bm;
     }
+    if (_analog_correction) {
+      result = _analog_correction(result, (res & 0x80) ? ADC_NATIVE_RESOLUTION + (res & 0x7F) : res, ADC0.COMMAND & ADC_DIFF_bm);
+    }
     return result;
   }
+
+  int32_t _analogReadEnh(uint8_t pin, uint8_t neg, uint8_t res, uint8_t gain) {
+    int32_t err = _analogReadEnhStart(pin, neg, res, gain);
+    if (err) return err;
+    return analogReadEnhResult();
+  }
+/* Ex Version*/
+  inline int32_t analogReadEnhStart(uint8_t pin, uint8_t res, uint8_t gain) {
+    check_valid_enh_res(res);
+    check_valid_analog_pin(pin);
+    if (__builtin_constant_p(gain)) {
+      if (gain != 0 && gain != 1 && gain != 2 && gain != 4 && gain != 8 && gain != 16){
+        badArg("The requested gain is not available on this part, accepted values are 0, 1, 2, 4, 8 and 16.");
+      }
+    }
+    return _analogReadEnhStart(pin, SINGLE_ENDED, res, gain);
+  }
+
+  inline int32_t analogReadDiffStart(uint8_t pos, uint8_t neg, uint8_t res, uint8_t gain) {
+    check_valid_enh_res(res);
+    check_valid_analog_pin(pos);
+    check_valid_negative_pin(neg);
+    if (__builtin_constant_p(gain)) {
+      if (gain != 0 && gain != 1 && gain != 2 && gain != 4 && gain != 8 && gain != 16){
+        badArg("The requested gain is not available on this part, accepted values are 0, 1, 2, 4, 8 and 16.");
+      }
+    }
+    return _analogReadEnhStart(pos, neg, res, gain);
+  }
 /* Ex Version*/
   inline int32_t analogReadEnh(uint8_t pin, uint8_t res, uint8_t gain) {
     check_valid_enh_res(res);
@@ -715,7 +816,7 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     return _adcref_to_c(r); //convert native representation back into compound representation containing the settinf for both AC and ADC so that we don't have two sets of constants that need to be used depending on
   }
 
-  int16_t analogRead(uint8_t pin) {
+  int16_t analogReadStart(uint8_t pin) {
     check_valid_analog_pin(pin);
     if (pin < 0x80) {
       // If high bit set, it's a channel, otherwise it's a digital pin so we look it up..
@@ -730,9 +831,9 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     #endif
       return ADC_ERROR_BAD_PIN_OR_CHANNEL;
     }
-    if (!ADC0.CTRLA & 0x01) return ADC_ERROR_DISABLED;
+    if (!(ADC0.CTRLA & 0x01)) return ADC_ERROR_DISABLED;
 
-    if (ADC0.COMMAND & ADC_START_gm) return ADC_ERROR_BUSY;
+    if ((ADC0.COMMAND & ADC_START_gm) || _analog_pending) return ADC_ERROR_BUSY;
     // gotta be careful here - don't want to shit ongoing conversion - unlikle classic AVRs
     // they say there is no buffering here!
     /* Select channel */
@@ -740,16 +841,31 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     uint8_t command = (_analog_options & 0x0F) > 8 ? 0x11 : 0x01;
     /* Start conversion */
     ADC0.COMMAND = command;
+    _analog_pending = ANALOG_PENDING_READ;
+    return 0;
+  }
 
+  int16_t analogReadResult() {
+    if (_analog_pending != ANALOG_PENDING_READ) return ADC_ERROR_BUSY;
     /* Wait for result ready */
     while (!(ADC0.INTFLAGS & ADC_RESRDY_bm));
+    _analog_pending = 0;
+    int16_t result = ADC0.RESULT;
     // if it's 10 bit compatibility mode, have to rightshift twice.
     if ((_analog_options & 0x0F) == 10) {
-      int16_t temp = ADC0.RESULT;
-      temp >>= 2;
-      return temp;
+      result >>= 2;
     }
-    return ADC0.RESULT;
+    if (_analog_correction) {
+      result = _analog_correction(result, _analog_options & 0x0F, false);
+    }
+    return result;
+  }
+
+  int16_t analogRead(uint8_t pin) {
+    check_valid_analog_pin(pin);
+    int16_t err = analogReadStart(pin);
+    if (err) return err;
+    return analogReadResult();
   }
 
 
@@ -820,7 +936,7 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
   }
 
 
-  int32_t _analogReadEnh(uint8_t pin, __attribute__ ((unused)) uint8_t neg, uint8_t res, __attribute__ ((unused)) uint8_t gain) {
+  int32_t _analogReadEnhStart(uint8_t pin, uint8_t res) {
     if (!(ADC0.CTRLA & 0x01)) return ADC_ENH_ERROR_DISABLED;
     uint8_t sampnum;
     if (res > 0x80) { // raw accumulation
@@ -848,7 +964,7 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     }
     pin &= 0x3F;
 
-    if (ADC0.COMMAND & ADC_START_gm) return ADC_ENH_ERROR_BUSY;
+    if ((ADC0.COMMAND & ADC_START_gm) || _analog_pending) return ADC_ENH_ERROR_BUSY;
 
 
     ADC0.MUXPOS =  pin;
@@ -856,7 +972,15 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     ADC0.CTRLF = sampnum;
     uint8_t command = ((res == 8) ? ADC_MODE_SINGLE_8BIT_gc : (res > ADC_NATIVE_RESOLUTION ? ADC_MODE_BURST_gc : ADC_MODE_SINGLE_10BIT_gc)) | 1;
     ADC0.COMMAND = command;
+    _analog_pending = res;
+    return 0;
+  }
+
+  int32_t analogReadEnhResult() {
+    uint8_t res = _analog_pending;
+    if (res == 0 || res == ANALOG_PENDING_READ) return ADC_ENH_ERROR_BUSY;
     while (!(ADC0.INTFLAGS & ADC_RESRDY_bm));
+    _analog_pending = 0;
     int32_t result = ADC0.RESULT;
 
     if (res < 0x80 && res > ADC_NATIVE_RESOLUTION) {
@@ -877,10 +1001,34 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     }
 
     // res > 0x80 (raw accumulate) or res == 8, res == 12 need no adjustment.
-
+    if (_analog_correction) {
+      result = _analog_correction(result, (res & 0x80) ? ADC_NATIVE_RESOLUTION + (res & 0x7F) : res, false);
+    }
     return result;
   }
 
+  int32_t _analogReadEnh(uint8_t pin, __attribute__ ((unused)) uint8_t neg, uint8_t res, __attribute__ ((unused)) uint8_t gain) {
+    int32_t err = _analogReadEnhStart(pin, res);
+    if (err) return err;
+    return analogReadEnhResult();
+  }
+
+  inline int32_t analogReadEnhStart(uint8_t pin, uint8_t res, __attribute__((unused)) uint8_t gain) {
+    check_valid_enh_res(res);
+    check_valid_analog_pin(pin);
+    if (__builtin_constant_p(gain)) {
+      if (gain != 0) {
+        badArg("Gain is not available on the AVR DU-series");
+      }
+    }
+    return _analogReadEnhStart(pin, res);
+  }
+
+  inline int32_t analogReadDiffStart(__attribute__((unused)) uint8_t pos, __attribute__((unused)) uint8_t neg, __attribute__((unused)) uint8_t res, __attribute__((unused)) uint8_t gain) {
+    badCall("The AVR DU-series is not equipped with a differential ADC.");
+    return 0xFFFFFFFF; // Can't happen, code that can execute this won't compile
+  }
+
   inline int32_t analogReadEnh(uint8_t pin, uint8_t res, __attribute__((unused)) uint8_t gain) {
     check_valid_enh_res(res);
     check_valid_analog_pin(pin);
@@ -956,7 +1104,11 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
     }
   }
 
-  int16_t analogRead(uint8_t pin) {
+  /* CTRLA and CTRLB as they were before analogReadEnh/DiffStart() changed them, to put back once we have the result. */
+  static uint8_t _analog_saved_ctrla;
+  static uint8_t _analog_saved_ctrlb;
+
+  int16_t analogReadStart(uint8_t pin) {
     check_valid_analog_pin(pin);
     if (pin < 0x80) {
       pin = digitalPinToAnalogInput(pin);
@@ -964,21 +1116,40 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
         return ADC_ERROR_BAD_PIN_OR_CHANNEL;
       }
     }
+    if (!(ADC0.CTRLA & ADC_ENABLE_bm)) return ADC_ERROR_DISABLED;
+    if ((ADC0.COMMAND & ADC_STCONV_bm) || _analog_pending) return ADC_ERROR_BUSY;
     /* Select channel */
     ADC0.MUXPOS = ((pin & 0x7F) << ADC_MUXPOS_gp);
     /* Reference should be already set up */
 
     /* Start conversion */
     ADC0.COMMAND = ADC_STCONV_bm;
+    _analog_pending = ANALOG_PENDING_READ;
+    return 0;
+  }
 
+  int16_t analogReadResult() {
+    if (_analog_pending != ANALOG_PENDING_READ) return ADC_ERROR_BUSY;
     /* Wait for result ready */
     while(!(ADC0.INTFLAGS & ADC_RESRDY_bm));
+    _analog_pending = 0;
 
     #if (defined(__AVR_DA__) && (!defined(NO_ADC_WORKAROUND)))
       // That may become defined when DA-series silicon is available with the fix
       ADC0.MUXPOS = 0x40;
     #endif
-    return ADC0.RES;
+    int16_t result = ADC0.RES;
+    if (_analog_correction) {
+      result = _analog_correction(result, getAnalogReadResolution(), false);
+    }
+    return result;
+  }
+
+  int16_t analogRead(uint8_t pin) {
+    check_valid_analog_pin(pin);
+    int16_t err = analogReadStart(pin);
+    if (err) return err;
+    return analogReadResult();
   }
 
 
@@ -1001,7 +1172,7 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
   }
 
 
-  int32_t _analogReadEnh(uint8_t pin, uint8_t neg, uint8_t res, __attribute__ ((unused)) uint8_t gain) {
+  int32_t _analogReadEnhStart(uint8_t pin, uint8_t neg, uint8_t res) {
     /* Combined implementation for enhanced and differential ADC reads. Gain is ignored, these have no PGA.
      * However, note that if the user passed a constant gain argument, which is what almost anyone would
      * do, THAT would be a compile error. Only deviant code that dynamically determines the gain and
@@ -1018,6 +1189,8 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
      *  3. Process the reading we took if needed - decimate where decimation is required and shift as
      *    as appropriate when the user has requested less than 12 bits of resolution.
      *  4. Restore registers we modified amd return results.
+     * Phases 1 and 2 are here, and 3 and 4 are in analogReadEnhResult(), so that the conversion can be started without
+     * waiting for it.
      */
 
     /*******************************
@@ -1049,7 +1222,7 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
             and try to use them with analogReadEnh(), instead of just returning whatever we get from reading the bogus channel */
       return ADC_ENH_ERROR_BAD_PIN_OR_CHANNEL;
     }
-    if (ADC0.COMMAND & ADC_STCONV_bm) {
+    if ((ADC0.COMMAND & ADC_STCONV_bm) || _analog_pending) {
       return ADC_ENH_ERROR_BUSY;
     /*  Doing the busy check up here so that if we are doing differential read, we
         find out before calculating MUXNEG, which we can now assign as soon as calculated..
@@ -1081,13 +1254,21 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
      *  Phase 2: Configure ADC and take reading  |
      ********************************************/
     ADC0.MUXPOS = pin;
-    uint8_t _ctrlb = ADC0.CTRLB;
-    uint8_t _ctrla = ADC0.CTRLA;
+    _analog_saved_ctrlb = ADC0.CTRLB;
+    _analog_saved_ctrla = ADC0.CTRLA;
     ADC0.CTRLA = ADC_ENABLE_bm | (res == ADC_NATIVE_RESOLUTION_LOW ? ADC_RESSEL_10BIT_gc : 0) | (neg == SINGLE_ENDED ? 0 : ADC_CONVMODE_bm);
     ADC0.CTRLB = sampnum;
 
     ADC0.COMMAND = ADC_STCONV_bm;
+    _analog_pending = res;
+    return 0;
+  }
+
+  int32_t analogReadEnhResult() {
+    uint8_t res = _analog_pending;
+    if (res == 0 || res == ANALOG_PENDING_READ) return ADC_ENH_ERROR_BUSY;
     while (!(ADC0.INTFLAGS & ADC_RESRDY_bm));
+    _analog_pending = 0;
     int32_t result = ADC0.RES; // This should clear the flag
     /******************************
      *  Phase 3: Post-processing  |
@@ -1116,6 +1297,16 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
         result >>= 1;
       }
     } // end of resolutions that require postprocessing.
+    if (_analog_correction) {
+      uint8_t bits = res;
+      if (res & 0x80) {  // raw accumulation - past 16 bits, the hardware has already truncated it to 16.
+        bits = ADC_NATIVE_RESOLUTION + (res & 0x7F);
+        if (bits > 16) {
+          bits = 16;
+        }
+      }
+      result = _analog_correction(result, bits, ADC0.CTRLA & ADC_CONVMODE_bm);
+    }
 
     /*******************************
      *  Phase 4: Cleanup + Return  |
@@ -1124,11 +1315,36 @@ inline __attribute__((always_inline)) void check_valid_resolution(uint8_t res) {
       // That may become defined when DA-series silicon is available with the fix
       ADC0.MUXPOS = 0x40;
     #endif
-    ADC0.CTRLB = _ctrlb;      // the user having something set in CTRLB is not implausuble
-    ADC0.CTRLA = _ctrla;      // undo the mess we just made in ADC0.CTRLA
+    ADC0.CTRLB = _analog_saved_ctrlb;   // the user having something set in CTRLB is not implausuble
+    ADC0.CTRLA = _analog_saved_ctrla;   // undo the mess we just made in ADC0.CTRLA
     return result;
   }
 
+  int32_t _analogReadEnh(uint8_t pin, uint8_t neg, uint8_t res, __attribute__ ((unused)) uint8_t gain) {
+    int32_t err = _analogReadEnhStart(pin, neg, res);
+    if (err) return err;
+    return analogReadEnhResult();
+  }
+
+  int32_t analogReadDiffStart(uint8_t pos, uint8_t neg, uint8_t res, uint8_t gain) {
+    check_valid_enh_res(res);
+    check_valid_analog_pin(pos);
+    check_valid_negative_pin(neg);
+    if (__builtin_constant_p(gain)){
+      if (gain != 0) badArg("This part does not have an amplifier; gain must be 0 or omitted");
+    }
+    return _analogReadEnhStart(pos, neg, res);
+  }
+
+  inline int32_t analogReadEnhStart(uint8_t pin, uint8_t res, uint8_t gain) {
+    check_valid_enh_res(res);
+    check_valid_analog_pin(pin);
+    if (__builtin_constant_p(gain)) {
+      if (gain != 0) badArg("This part does not have an amplifier; gain must be 0 or omitted");
+    }
+    return _analogReadEnhStart(pin, SINGLE_ENDED, res);
+  }
+
   int32_t analogReadDiff(uint8_t pos, uint8_t neg, uint8_t res, uint8_t gain) {
     check_valid_enh_res(res);
     check_valid_analog_pin(pos);
@@ -0,0 +1,186 @@
+/* wiring_analog_window.c - watch an analog input with the ADC window comparator, and get a callback when the reading enters
+ * or leaves a range, instead of polling analogRead().
+ * Part of DxCore - github.com/SpenceKonde/DxCore
+ * Free Software - LGPL 2.1, please see LICENCE.md for details
+ *
+ * The window comparator checks every conversion result against WINLT and WINHT, and only raises its interrupt if the result
+ * matches the mode in WINCM. We take one reading first to see which side we're on; if it's inside, we start in OUTSIDE mode,
+ * so nothing happens until a reading is outside the window. Then we call the callback and switch to INSIDE mode, so nothing
+ * more happens until a reading is back inside, and so on. That way, the CPU only hears about crossings - it can sleep in
+ * between, since the ADC can run in standby, either free running, or started by an event, like the RTC PIT, which uses far
+ * less power for slowly changing signals.
+ *
+ * The ADC interrupt is in this file, so none of this is linked in unless analogWindowStart() is called.
+ */
+
+#include "Arduino.h"
+
+static analogWindowFuncPtr _window_callback;
+static volatile uint8_t    _window_state;   // bit 0: inside, bit 7: running
+static uint8_t             _window_saved;   // CTRLA (for RUNSTBY) as it was before we started.
+
+// The reading we seed the state with is inside only if the comparator's INSIDE mode would say so: strictly between them.
+static inline uint8_t _window_seed(int16_t value, int16_t low, int16_t high) {
+  return (value > low && value < high) ? 1 : 0;
+}
+
+#if defined(ADC_WINSRC_bm) && defined(ADC0_SAMPRDY_vect)
+  /*############### Ex-series and DU-series ###############*/
+  /* The DU-series has the same window comparator as the Ex-series. Its ADC is 10 bits, not 12, but the command that asks
+   * for the higher resolution has the same value, so the only other differences are in the names. */
+  #if defined(ADC0_TEMP2)
+    #define WINDOW_MODE_SINGLE  ADC_MODE_SINGLE_12BIT_gc
+    #define WINDOW_SRC_RESULT   ADC_WINSRC_RESULT_gc
+  #else
+    #define WINDOW_MODE_SINGLE  ADC_MODE_SINGLE_10BIT_gc
+    #define WINDOW_SRC_RESULT   0               // WINSRC clear: compare RESULT, not SAMPLE
+    #define ADC_RUNSTDBY_bm     ADC_RUNSTBY_bm
+  #endif
+  static uint8_t           _window_shift;   // how far to shift results to get analogRead() results, as analogRead() does.
+
+  bool analogWindowStart(uint8_t pin, int16_t low, int16_t high, analogWindowFuncPtr callback, uint8_t trigger) {
+    if (pin < 0x80) {
+      pin = digitalPinToAnalogInput(pin);
+      if (pin == NOT_A_PIN) {
+        return false;
+      }
+    }
+    if (!(ADC0.CTRLA & ADC_ENABLE_bm) || (ADC0.COMMAND & ADC_START_gm) || analogReadPending() || low > high) {
+      return false;
+    }
+    uint8_t res = getAnalogReadResolution();
+    uint8_t mode = (res == 8) ? ADC_MODE_SINGLE_8BIT_gc : WINDOW_MODE_SINGLE;
+    _window_shift = (res == 10) ? 2 : 0;
+    _window_callback = callback;
+    _window_saved = ADC0.CTRLA;
+    ADC0.MUXPOS = pin & 0x3F;
+    ADC0.CTRLD &= ~ADC_WINCM_gm;
+    ADC0.CTRLF &= ~(ADC_SAMPNUM_gm | ADC_FREERUN_bm);
+    ADC0.INTFLAGS = ADC_RESRDY_bm;
+    ADC0.COMMAND = mode | ADC_START_IMMEDIATE_gc; // one reading, to find out which side of the window we start on.
+    while (!(ADC0.INTFLAGS & ADC_RESRDY_bm));
+    uint8_t inside = _window_seed(ADC0.RESULT >> _window_shift, low, high);
+    _window_state = 0x80 | inside;
+    ADC0.WINLT = low << _window_shift;
+    ADC0.WINHT = high << _window_shift;
+    ADC0.CTRLD = (ADC0.CTRLD & ~ADC_WINSRC_bm) | (inside ? ADC_WINCM_OUTSIDE_gc : ADC_WINCM_INSIDE_gc) | WINDOW_SRC_RESULT;
+    ADC0.CTRLF |= (trigger == ADC_WINDOW_EVENT ? 0 : ADC_FREERUN_bm);
+    ADC0.CTRLA |= ADC_RUNSTDBY_bm;
+    ADC0.INTFLAGS = ADC_RESRDY_bm | ADC_WCMP_bm;
+    ADC0.INTCTRL = ADC_WCMP_bm;
+    ADC0.COMMAND = mode | (trigger == ADC_WINDOW_EVENT ? ADC_START_EVENT_TRIGGER_gc : ADC_START_IMMEDIATE_gc);
+    return true;
+  }
+
+  void analogWindowStop() {
+    uint8_t oldSREG = SREG;
+    cli();
+    if (_window_state & 0x80) {
+      ADC0.COMMAND = ADC_START_STOP_gc;
+      ADC0.CTRLF &= ~ADC_FREERUN_bm;
+      ADC0.INTCTRL = 0;
+      ADC0.CTRLD &= ~ADC_WINCM_gm;
+      ADC0.INTFLAGS = ADC_RESRDY_bm | ADC_WCMP_bm;
+      ADC0.CTRLA = (ADC0.CTRLA & ~ADC_RUNSTDBY_bm) | (_window_saved & ADC_RUNSTDBY_bm);
+      _window_state = 0;
+    }
+    SREG = oldSREG;
+  }
+
+  // On the Ex-series and DU-series, the window comparator shares the sample ready vector.
+  ISR(ADC0_SAMPRDY_vect) {
+    int16_t value = ADC0.RESULT >> _window_shift;
+    ADC0.INTFLAGS = ADC_RESRDY_bm | ADC_WCMP_bm;
+    uint8_t inside = ((ADC0.CTRLD & ADC_WINCM_gm) == ADC_WINCM_INSIDE_gc);
+    ADC0.CTRLD = (ADC0.CTRLD & ~ADC_WINCM_gm) | (inside ? ADC_WINCM_OUTSIDE_gc : ADC_WINCM_INSIDE_gc);
+    _window_state = 0x80 | inside;
+    if (_window_callback) {
+      _window_callback(inside, value);
+    }
+  }
+
+#elif defined(ADC0_WCMP_vect)
+  /*############### Dx-series ###############*/
+  static uint8_t _window_saved_ctrlb;
+
+  bool analogWindowStart(uint8_t pin, int16_t low, int16_t high, analogWindowFuncPtr callback, uint8_t trigger) {
+    if (pin < 0x80) {
+      pin = digitalPinToAnalogInput(pin);
+      if (pin == NOT_A_PIN) {
+        return false;
+      }
+    }
+    if (!(ADC0.CTRLA & ADC_ENABLE_bm) || (ADC0.COMMAND & ADC_STCONV_bm) || (ADC0.CTRLA & ADC_FREERUN_bm) || analogReadPending() || low > high) {
+      return false;
+    }
+    _window_callback = callback;
+    _window_saved = ADC0.CTRLA;
+    _window_saved_ctrlb = ADC0.CTRLB;
+    ADC0.MUXPOS = pin & 0x7F;
+    ADC0.CTRLB = 0;                               // no accumulation
+    ADC0.CTRLE = ADC_WINCM_NONE_gc;
+    ADC0.INTFLAGS = ADC_RESRDY_bm;                // so that it's this reading we wait for, not one left over
+    ADC0.COMMAND = ADC_STCONV_bm;                 // one reading, to find out which side of the window we start on.
+    while (!(ADC0.INTFLAGS & ADC_RESRDY_bm));
+    uint8_t inside = _window_seed(ADC0.RES, low, high);
+    _window_state = 0x80 | inside;
+    ADC0.WINLT = low;
+    ADC0.WINHT = high;
+    ADC0.CTRLE = inside ? ADC_WINCM_OUTSIDE_gc : ADC_WINCM_INSIDE_gc;
+    ADC0.INTFLAGS = ADC_RESRDY_bm | ADC_WCMP_bm;
+    ADC0.INTCTRL = ADC_WCMP_bm;
+    if (trigger == ADC_WINDOW_EVENT) {
+      ADC0.CTRLA |= ADC_RUNSTBY_bm;
+      ADC0.EVCTRL = ADC_STARTEI_bm;
+    } else {
+      ADC0.CTRLA |= ADC_RUNSTBY_bm | ADC_FREERUN_bm;
+      ADC0.COMMAND = ADC_STCONV_bm;
+    }
+    return true;
+  }
+
+  void analogWindowStop() {
+    uint8_t oldSREG = SREG;
+    cli();
+    if (_window_state & 0x80) {
+      ADC0.EVCTRL = 0;
+      ADC0.CTRLA &= ~ADC_FREERUN_bm;
+      ADC0.COMMAND = ADC_SPCONV_bm;
+      ADC0.INTCTRL = 0;
+      ADC0.CTRLE = ADC_WINCM_NONE_gc;
+      ADC0.INTFLAGS = ADC_RESRDY_bm | ADC_WCMP_bm;
+      ADC0.CTRLB = _window_saved_ctrlb;
+      ADC0.CTRLA = (ADC0.CTRLA & ~ADC_RUNSTBY_bm) | (_window_saved & ADC_RUNSTBY_bm);
+      #if (defined(ERRATA_ADC_PIN_DISABLE) && ERRATA_ADC_PIN_DISABLE != 0)
+        ADC0.MUXPOS = 0x40;
+      #endif
+      _window_state = 0;
+    }
+    SREG = oldSREG;
+  }
+
+  ISR(ADC0_WCMP_vect) {
+    int16_t value = ADC0.RES;
+    ADC0.INTFLAGS = ADC_RESRDY_bm | ADC_WCMP_bm;
+    uint8_t inside = (ADC0.CTRLE == ADC_WINCM_INSIDE_gc);
+    ADC0.CTRLE = inside ? ADC_WINCM_OUTSIDE_gc : ADC_WINCM_INSIDE_gc;
+    _window_state = 0x80 | inside;
+    if (_window_callback) {
+      _window_callback(inside, value);
+    }
+  }
+
+#else
+  bool analogWindowStart(__attribute__((unused)) uint8_t pin, __attribute__((unused)) int16_t low, __attribute__((unused)) int16_t high,
+                         __attribute__((unused)) analogWindowFuncPtr callback, __attribute__((unused)) uint8_t trigger) {
+    badCall("analogWindowStart() is not yet supported on this part");
+    return false;
+  }
+  void analogWindowStop() {
+    badCall("analogWindowStop() is not yet supported on this part");
+  }
+#endif
+
+bool analogWindowInside() {
+  return _window_state & 0x01;
+}
@@ -248,6 +248,11 @@ void turnOffPWM(uint8_t pin) {
     /* Okay, seriously? The datasheets and io headers disagree here for tinyAVR
        about whether the low bits even exist! Much less whether they need to be
        set - but if they are not set, it will not work */
+    #if defined(MILLIS_TICKLESS)
+      // The tickless millis TCB counts TCA0's prescaled clock, so start it right back up at the same prescaler.
+      // It was only stopped for a few clocks, far less than a tick. The user must leave CLKSEL and ENABLE alone.
+      TCA0.SPLIT.CTRLA = TICKLESS_TCA_CLKSEL | TCA_SPLIT_ENABLE_bm;
+    #endif
   }
 
   void resumeTCA0() {
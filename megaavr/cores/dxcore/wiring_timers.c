@@ -0,0 +1,248 @@
+/* wiring_timers.c - software timers: call a function once after some number of milliseconds, or every so many milliseconds.
+ * Part of DxCore - github.com/SpenceKonde/DxCore
+ * Free Software - LGPL 2.1, please see LICENCE.md for details
+ *
+ * The timers live in a hierarchical timer wheel, like the one the Linux kernel used for years. There are four levels of 16
+ * slots each. Level 0 holds timers that expire in the next 16 ms, one slot per ms; level 1 holds those due in the next 256 ms,
+ * one slot per 16 ms, and so on up to level 3, which covers 65.536 seconds. Anything further off than that waits on an
+ * overflow list. Each slot is a linked list, so starting or cancelling a timer is a handful of pointer assignments no matter
+ * how many timers there are. Each ms, we run whatever is in that ms's level 0 slot. Every 16 ms, the next level 1 slot is
+ * emptied and its timers re-filed into level 0 (or wherever they now belong), every 256 ms the next level 2 slot, and so on.
+ *
+ * Callbacks are NOT run from the millis interrupt. The millis ISR is hand-tuned assembly that every sketch pays for, and
+ * callbacks run in an ISR can't do anything that needs interrupts (like printing more than a buffer's worth). Instead,
+ * runTimers() is called after each pass through loop() and while waiting in delay(), and you can call it yourself from
+ * anywhere else you wait. Timers are never run early; they are run late by however long it was since runTimers() was last
+ * called. Periodic timers keep to their original schedule, so one late call doesn't push all the later ones back.
+ *
+ * None of this gets linked in unless you start a timer: main() and delay() only call runTimers() if something else pulled this
+ * file in. The wheel takes 130 bytes of RAM, and each timer 14 bytes, which you provide - there is no malloc here.
+ */
+
+#include "Arduino.h"
+
+#if !defined(MILLIS_USE_TIMERNONE)
+
+#define TIMER_WHEEL_BITS   4
+#define TIMER_WHEEL_SLOTS  (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK   (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 4
+
+static softTimer_t *_wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static softTimer_t *_wheel_overflow;
+static softTimer_t *_wheel_running;       // The timers due this ms, which we're in the middle of running.
+static uint32_t     _wheel_next;          // The next ms to process; all ms before it have been run.
+static uint8_t      _wheel_count;         // Number of timers pending.
+static uint8_t      _wheel_busy;          // Set while runTimers() is running, in case a callback calls delay().
+
+// All of these must be called with interrupts disabled.
+static void _timer_link(softTimer_t **list, softTimer_t *t) {
+  t->next = *list;
+  if (t->next) {
+    t->next->pprev = &t->next;
+  }
+  *list = t;
+  t->pprev = list;
+}
+
+static void _timer_unlink(softTimer_t *t) {
+  *(t->pprev) = t->next;
+  if (t->next) {
+    t->next->pprev = t->pprev;
+  }
+  t->pprev = NULL;
+}
+
+static void _timer_file(softTimer_t *t) {
+  uint32_t expires = t->expires;
+  uint32_t delta = expires - _wheel_next;
+  softTimer_t **list;
+  if ((int32_t) delta < 0) {            // Already due (we're behind) - file it under the next ms to be run.
+    expires = _wheel_next;
+    delta = 0;
+  }
+  if (delta < (1UL << (TIMER_WHEEL_BITS))) {
+    list = &_wheel[0][expires & TIMER_WHEEL_MASK];
+  } else if (delta < (1UL << (2 * TIMER_WHEEL_BITS))) {
+    list = &_wheel[1][(expires >> TIMER_WHEEL_BITS) & TIMER_WHEEL_MASK];
+  } else if (delta < (1UL << (3 * TIMER_WHEEL_BITS))) {
+    list = &_wheel[2][(expires >> (2 * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK];
+  } else if (delta < (1UL << (4 * TIMER_WHEEL_BITS))) {
+    list = &_wheel[3][(expires >> (3 * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK];
+  } else {
+    list = &_wheel_overflow;
+  }
+  _timer_link(list, t);
+}
+
+// Re-file everything in a list now that time has moved on. Timers that were far off move down a level.
+static void _timer_cascade(softTimer_t **list) {
+  softTimer_t *t = *list;
+  *list = NULL;                           // Some may go right back in this list (overflow), so take them all out first.
+  while (t) {
+    softTimer_t *next = t->next;
+    _timer_file(t);
+    t = next;
+  }
+}
+
+static void _timer_start(softTimer_t *timer, uint32_t ms, uint32_t period, voidFuncPtr callback) {
+  uint32_t now = millis();
+  uint8_t oldSREG = SREG;
+  cli();
+  if (timer->pprev) {
+    _timer_unlink(timer);
+  } else {
+    if (!_wheel_count++ && !_wheel_busy) {
+      _wheel_next = now;                  // Nothing was pending, so there's nothing to catch up on.
+    }
+  }
+  timer->expires  = now + ms;
+  timer->period   = period;
+  timer->callback = callback;
+  _timer_file(timer);
+  SREG = oldSREG;
+}
+
+void timerOnce(softTimer_t *timer, uint32_t ms, voidFuncPtr callback) {
+  _timer_start(timer, ms, 0, callback);
+}
+
+void timerEvery(softTimer_t *timer, uint32_t ms, voidFuncPtr callback) {
+  if (ms == 0) {
+    ms = 1;                               // Every 0 ms would never let runTimers() return.
+  }
+  _timer_start(timer, ms, ms, callback);
+}
+
+void timerCancel(softTimer_t *timer) {
+  uint8_t oldSREG = SREG;
+  cli();
+  if (timer->pprev) {
+    _timer_unlink(timer);
+    _wheel_count--;
+  }
+  SREG = oldSREG;
+}
+
+#if defined(MILLIS_TICKLESS)
+  /* The millis timer only interrupts when it has to, so ask it to wake us in time for the next thing that needs doing. That's
+   * either the first timer in level 0, or the next time a slot in a higher level needs to be re-filed, whichever is first. We
+   * don't know when the timers in a higher level slot expire, only that it's no sooner than the slot is re-filed. */
+  static void _timer_wake() {
+    uint32_t next = _wheel_next;
+    uint32_t soonest = next + 0x7FFFFFFFUL;
+    uint8_t level = 0;
+    for (; level < TIMER_WHEEL_LEVELS; level++) {
+      uint8_t shift = level * TIMER_WHEEL_BITS;
+      uint32_t step = 1UL << shift;
+      uint32_t when = (next + step - 1) & ~(step - 1); // The first time this level is looked at.
+      for (uint8_t i = 0; i < TIMER_WHEEL_SLOTS; i++, when += step) {
+        if (_wheel[level][(when >> shift) & TIMER_WHEEL_MASK]) {
+          if ((int32_t)(when - soonest) < 0) {
+            soonest = when;
+          }
+          break;
+        }
+      }
+    }
+    if (_wheel_overflow) {
+      uint32_t when = (next + 0xFFFFUL) & ~0xFFFFUL;
+      if ((int32_t)(when - soonest) < 0) {
+        soonest = when;
+      }
+    }
+    if (soonest - next > 1800000UL) {
+      soonest = next + 1800000UL;         // wake_at_micros() can only look half an hour ahead.
+    }
+    wake_at_micros(soonest * 1000);
+  }
+#endif
+
+void runTimers() {
+  uint8_t oldSREG = SREG;
+  cli();
+  if (_wheel_busy) {
+    SREG = oldSREG;
+    return;
+  }
+  uint32_t now = millis();
+  if (!_wheel_count) {
+    _wheel_next = now;
+    SREG = oldSREG;
+    return;
+  }
+  _wheel_busy = 1;
+  while ((int32_t)(now - _wheel_next) >= 0) {
+    uint32_t tick = _wheel_next;
+    if (!(tick & TIMER_WHEEL_MASK)) {
+      _timer_cascade(&_wheel[1][(tick >> TIMER_WHEEL_BITS) & TIMER_WHEEL_MASK]);
+      if (!(tick & ((1UL << (2 * TIMER_WHEEL_BITS)) - 1))) {
+        _timer_cascade(&_wheel[2][(tick >> (2 * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK]);
+        if (!(tick & ((1UL << (3 * TIMER_WHEEL_BITS)) - 1))) {
+          _timer_cascade(&_wheel[3][(tick >> (3 * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK]);
+          if (!(tick & ((1UL << (4 * TIMER_WHEEL_BITS)) - 1))) {
+            _timer_cascade(&_wheel_overflow);
+          }
+        }
+      }
+    }
+    // Move this ms's timers to their own list, so that timers started by the callbacks can't end up in it.
+    softTimer_t **slot = &_wheel[0][tick & TIMER_WHEEL_MASK];
+    _wheel_running = *slot;
+    if (_wheel_running) {
+      _wheel_running->pprev = &_wheel_running;
+    }
+    *slot = NULL;
+    _wheel_next = tick + 1;
+    softTimer_t *t;
+    while ((t = _wheel_running)) {
+      _timer_unlink(t);
+      if (t->period) {
+        do {
+          t->expires += t->period;
+        } while ((int32_t)(t->expires - now) <= 0);        // If we fell behind, skip the calls we missed.
+        _timer_file(t);
+      } else {
+        _wheel_count--;
+      }
+      voidFuncPtr callback = t->callback;
+      SREG = oldSREG;
+      callback();                         // The callback can start or cancel any timer, including this one.
+      cli();
+    }
+    if (!_wheel_count) {
+      _wheel_next = now;
+      break;
+    }
+    SREG = oldSREG;                       // Let any interrupts that are waiting run, in case we have a lot to catch up on.
+    cli();
+  }
+  #if defined(MILLIS_TICKLESS)
+    if (_wheel_count) {
+      _timer_wake();
+    }
+  #endif
+  _wheel_busy = 0;
+  SREG = oldSREG;
+}
+/* main() and delay() call this through a weak reference, so that they only do so if this file was linked in, which only
+ * happens if something starts a timer. */
+void _runTimers() __attribute__((alias("runTimers")));
+
+#else
+
+void timerOnce(__attribute__((unused)) softTimer_t *timer, __attribute__((unused)) uint32_t ms, __attribute__((unused)) voidFuncPtr callback) {
+  badCall("Software timers need millis() - they can't be used with millis disabled.");
+}
+void timerEvery(__attribute__((unused)) softTimer_t *timer, __attribute__((unused)) uint32_t ms, __attribute__((unused)) voidFuncPtr callback) {
+  badCall("Software timers need millis() - they can't be used with millis disabled.");
+}
+void timerCancel(__attribute__((unused)) softTimer_t *timer) {
+  return;
+}
+void runTimers() {
+  return;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/* CalibrateAndSave - the first time it runs (or whenever 'c' is sent), measure the ADC offset and gain with the 2.048V
+ * reference, and save them in the USERROW. Every other time, just load them. Then print corrected readings of PD1.
+ *
+ * The gain is measured from VDD/10, so VDD has to be a known, regulated voltage - set VDD_MILLIVOLTS to what yours really
+ * is (measure it). Parts without VDD/10 (the DA-series) use a known voltage on PD2 instead.
+ */
+#include <ADCCalibration.h>
+
+#define VDD_MILLIVOLTS       3300
+#define KNOWN_PIN_MILLIVOLTS 1500
+
+void calibrate() {
+  ADCCalibration.clear();
+  int16_t offset;
+  if (!ADCCalibration.calibrateOffset(offset)) {
+    Serial.println("Offset calibration failed");
+    return;
+  }
+  Serial.print("Offset (1/65536ths): ");
+  Serial.println(offset);
+  #if defined(ADC_VDDDIV10)
+    bool ok = ADCCalibration.calibrateGain(ADC_VDDDIV10, VDD_MILLIVOLTS / 10);
+  #else
+    bool ok = ADCCalibration.calibrateGain(PIN_PD2, KNOWN_PIN_MILLIVOLTS);
+  #endif
+  if (!ok) {
+    Serial.println("Gain calibration failed");
+    return;
+  }
+  ADCCalEntry cal;
+  ADCCalibration.get(INTERNAL2V048, cal);
+  Serial.print("Gain correction (1/65536ths): ");
+  Serial.println(cal.gain);
+  Serial.print("Saved, bytes used: ");
+  Serial.println(ADCCalibration.save());
+}
+
+void setup() {
+  Serial.begin(115200);
+  analogReference(INTERNAL2V048);
+  analogReadResolution(12);
+  delay(10);                              // let the reference settle
+  if (!ADCCalibration.load()) {
+    Serial.println("No calibration saved yet");
+    calibrate();
+  }
+}
+
+void loop() {
+  if (Serial.read() == 'c') {
+    calibrate();
+  }
+  int32_t reading = analogReadEnh(PIN_PD1, 16);   // corrected, at no more cost than a few multiplies.
+  Serial.print(reading);
+  Serial.print(" = ");
+  Serial.print((reading * 2048) >> 16);
+  Serial.println(" mV");
+  delay(500);
+}
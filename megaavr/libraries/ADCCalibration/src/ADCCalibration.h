@@ -0,0 +1,259 @@
+/* ADCCalibration.h - measure the ADC's offset and gain error once for each reference, keep them in the USERROW, and have
+ * analogRead(), analogReadEnh() and analogReadDiff() correct every result with them, for DxCore.
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * The offset is measured by reading ground against ground with a differential reading, so that an offset below zero shows
+ * up too (a single ended reading can't go below 0). The DU-series has no differential mode, so there we can only see a
+ * positive offset. The gain is measured by reading a voltage you know - VDD/10 with a regulated supply, a reference you
+ * have measured, or a precision voltage on a pin - and comparing that with what it should read.
+ *
+ * Both are kept in fractions of the reference voltage (1/65536ths), and the gain as a correction factor in 1/65536ths, so
+ * that one pair of numbers works at every resolution, and the correction is a subtraction, a shift and two small multiplies
+ * - no floating point. The correction is installed with analogSetCorrection(); until there is a calibration for the current
+ * reference, the results are left alone.
+ *
+ * Like USERSIG.h, which it uses, this is all in the header, so it must only be included in one file of a sketch.
+ */
+
+#ifndef ADCCALIBRATION_H
+#define ADCCALIBRATION_H
+#include <Arduino.h>
+#include <USERSIG.h>
+
+#define ADCCAL_SIGNATURE  0xCA  // marks a saved calibration in the USERROW
+#define ADCCAL_RESOLUTION ADC_MAX_OVERSAMPLED_RESOLUTION
+#if defined(ADC_LOWLAT_bm) && !defined(ADC0_TEMP2)
+  #define ADCCAL_NO_DIFFERENTIAL    // DU-series. The Ex-series has LOWLAT too, but also the bigger ADC, which has TEMP2.
+#endif
+
+typedef struct {
+  int16_t offset;   // in 1/65536ths of the reference (1/16ths of a 12-bit LSB)
+  int16_t gain;     // correction factor minus 1, in 1/65536ths: 0 for none, 655 to make readings 1% higher.
+} ADCCalEntry;
+
+class ADCCalibrationClass {
+  public:
+    /* Measure the offset with the current reference, and start correcting readings taken with it. offset is set to it, in
+     * 1/65536ths of the reference. Returns false, and leaves offset alone, if the reading failed. Do this before
+     * calibrateGain(). */
+    bool calibrateOffset(int16_t &offset);
+    bool calibrateOffset() {
+      int16_t offset;
+      return calibrateOffset(offset);
+    }
+    /* Read pin (or an ADC_CH() channel such as ADC_VDDDIV10), which you know to be at millivolts, and work out the gain
+     * correction for the current reference from that. referenceMillivolts is what the reference really is - needed if it
+     * is VDD or EXTERNAL, and otherwise, 0 means the nominal voltage of the internal reference. The closer millivolts is to
+     * the reference, the better. Returns false if the reading failed, or was more than 50% off. */
+    bool calibrateGain(uint8_t pin, uint16_t millivolts, uint16_t referenceMillivolts = 0);
+    // Set or get the calibration for a reference (INTERNAL2V048, VDD, etc) directly.
+    void set(uint8_t reference, ADCCalEntry entry);
+    bool get(uint8_t reference, ADCCalEntry &entry);
+    // Forget all calibrations, and stop correcting readings.
+    void clear();
+    /* Save the calibrations in the USERROW, starting at address. It takes 2 bytes, plus 4 for each reference calibrated.
+     * Returns the number of bytes used, or -1 if they don't fit or the write failed. */
+    int8_t save(uint8_t address = 0);
+    // Load calibrations saved with save(), and start correcting readings. Returns false if there aren't any at address.
+    bool load(uint8_t address = 0);
+    // Turn correction on or off without forgetting the calibrations.
+    void enable() {
+      analogSetCorrection(correct);
+    }
+    void disable() {
+      analogSetCorrection(NULL);
+    }
+    // The correction, as the core calls it.
+    static int32_t correct(int32_t value, uint8_t bits, bool differential);
+
+    ADCCalEntry _table[8];     // indexed by the reference's selection value
+    uint8_t     _valid = 0;    // bit n set if _table[n] is a calibration
+
+  private:
+    // A result with full scale of 2^bits, scaled to 1/65536ths of the reference.
+    static int32_t _toRef(int32_t value, uint8_t bits) {
+      return (bits <= 16) ? (value << (16 - bits)) : (value >> (bits - 16));
+    }
+};
+
+static ADCCalibrationClass ADCCalibration;
+
+inline int32_t ADCCalibrationClass::correct(int32_t value, uint8_t bits, bool differential) {
+  uint8_t ref = getAnalogReference() & 0x07;
+  if (!(ADCCalibration._valid & (1 << ref))) {
+    return value;
+  }
+  const ADCCalEntry &cal = ADCCalibration._table[ref];
+  // A differential result spans -VREF to VREF, so it has one bit less per volt.
+  int8_t shift = bits - differential - 16;
+  int32_t offset = cal.offset;
+  if (shift >= 0) {
+    offset <<= shift;
+  } else {
+    offset = (offset + (1 << (-shift - 1))) >> -shift;
+  }
+  value -= offset;
+  if (cal.gain) {
+    // value * gain / 65536, in two pieces so that it can't overflow.
+    value += ((value >> 8) * cal.gain + (((value & 0xFF) * cal.gain) >> 8)) >> 8;
+  }
+  if (!differential) {
+    int32_t top = (1L << bits) - 1;
+    if (value < 0) {
+      value = 0;
+    } else if (value > top) {
+      value = top;
+    }
+  }
+  return value;
+}
+
+inline bool ADCCalibrationClass::calibrateOffset(int16_t &offset) {
+  uint8_t ref = getAnalogReference() & 0x07;
+  disable();
+  #if defined(ADCCAL_NO_DIFFERENTIAL)
+    int32_t r = analogReadEnh(ADC_GROUND, ADCCAL_RESOLUTION, 0);
+  #else
+    int32_t r = analogReadDiff(ADC_GROUND, ADC_GROUND, ADCCAL_RESOLUTION, 0);
+  #endif
+  if (_valid) {
+    enable();
+  }
+  if (r <= ADC_ENH_ERROR_BAD_PIN_OR_CHANNEL) {
+    return false;
+  }
+  #if defined(ADCCAL_NO_DIFFERENTIAL)
+    offset = _toRef(r, ADCCAL_RESOLUTION);
+  #else
+    offset = _toRef(r, ADCCAL_RESOLUTION - 1);
+  #endif
+  if (!(_valid & (1 << ref))) {
+    _table[ref].gain = 0;
+  }
+  _table[ref].offset = offset;
+  _valid |= (1 << ref);
+  enable();
+  return true;
+}
+
+inline bool ADCCalibrationClass::calibrateGain(uint8_t pin, uint16_t millivolts, uint16_t referenceMillivolts) {
+  uint8_t reference = getAnalogReference();
+  if (referenceMillivolts == 0) {
+    switch (reference) {
+      case INTERNAL1V024:
+        referenceMillivolts = 1024;
+        break;
+      case INTERNAL2V048:
+        referenceMillivolts = 2048;
+        break;
+      case INTERNAL2V500:
+        referenceMillivolts = 2500;
+        break;
+      case INTERNAL4V096:
+        referenceMillivolts = 4096;
+        break;
+      default:
+        return false;   // VDD or EXTERNAL - we can't know what that is.
+    }
+  }
+  if (millivolts == 0 || millivolts >= referenceMillivolts) {
+    return false;
+  }
+  uint8_t ref = reference & 0x07;
+  disable();
+  int32_t r = analogReadEnh(pin, ADCCAL_RESOLUTION, 0);
+  if (_valid) {
+    enable();
+  }
+  if (r <= ADC_ENH_ERROR_BAD_PIN_OR_CHANNEL) {
+    return false;
+  }
+  int32_t offset   = (_valid & (1 << ref)) ? _table[ref].offset : 0;
+  int32_t measured = _toRef(r, ADCCAL_RESOLUTION) - offset;
+  int32_t expected = ((uint32_t) millivolts << 16) / referenceMillivolts;
+  if (measured <= 0) {
+    return false;
+  }
+  float gain = ((float) expected / measured - 1.0f) * 65536.0f;   // once, at calibration time, so float is fine here.
+  if (gain > 32767.0f || gain < -32768.0f) {
+    return false;
+  }
+  _table[ref].offset = offset;
+  _table[ref].gain   = (int16_t) gain;
+  _valid |= (1 << ref);
+  enable();
+  return true;
+}
+
+inline void ADCCalibrationClass::set(uint8_t reference, ADCCalEntry entry) {
+  _table[reference & 0x07] = entry;
+  _valid |= 1 << (reference & 0x07);
+  enable();
+}
+
+inline bool ADCCalibrationClass::get(uint8_t reference, ADCCalEntry &entry) {
+  if (!(_valid & (1 << (reference & 0x07)))) {
+    return false;
+  }
+  entry = _table[reference & 0x07];
+  return true;
+}
+
+inline void ADCCalibrationClass::clear() {
+  _valid = 0;
+  disable();
+}
+
+inline int8_t ADCCalibrationClass::save(uint8_t address) {
+  uint8_t length = 2;
+  for (uint8_t i = 0; i < 8; i++) {
+    if (_valid & (1 << i)) {
+      length += sizeof(ADCCalEntry);
+    }
+  }
+  if ((uint16_t) address + length > USER_SIGNATURES_SIZE) {
+    return -1;
+  }
+  uint8_t a = address;
+  USERSIG.write(a++, ADCCAL_SIGNATURE);
+  USERSIG.write(a++, _valid);
+  for (uint8_t i = 0; i < 8; i++) {
+    if (_valid & (1 << i)) {
+      const uint8_t *p = (const uint8_t *) &_table[i];
+      for (uint8_t j = 0; j < sizeof(ADCCalEntry); j++) {
+        USERSIG.write(a++, p[j]);
+      }
+    }
+  }
+  if (USERSIG.flush() < 0) {
+    return -1;
+  }
+  return length;
+}
+
+inline bool ADCCalibrationClass::load(uint8_t address) {
+  if ((uint16_t) address + 2 > USER_SIGNATURES_SIZE || USERSIG.read(address) != ADCCAL_SIGNATURE) {
+    return false;
+  }
+  uint8_t valid = USERSIG.read(address + 1);
+  uint8_t a = address + 2;
+  for (uint8_t i = 0; i < 8; i++) {
+    if (valid & (1 << i)) {
+      if ((uint16_t) a + sizeof(ADCCalEntry) > USER_SIGNATURES_SIZE) {
+        return false;
+      }
+      uint8_t *p = (uint8_t *) &_table[i];
+      for (uint8_t j = 0; j < sizeof(ADCCalEntry); j++) {
+        p[j] = USERSIG.read(a++);
+      }
+    }
+  }
+  _valid = valid;
+  if (valid) {
+    enable();
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,49 @@
+/* OversampledVoltage - read PD1 with 16 bits of resolution, 50 times a second, from the ADC interrupt, and print the
+ * voltage once a second, averaged over those 50 readings. Each reading is the sum of 256 12-bit samples, so that's 12800
+ * samples per second - the CPU only hears about them 16 at a time (on the Ex-series, 256 at a time).
+ *
+ * For 17 bits at 50 Hz, it would take 4 times as many: 51200 samples per second, which is more than the ADC can do at its
+ * default settings. Speed it up with analogClockSpeed() and analogSampleDuration() first (see the README).
+ */
+#include <ADCOversample.h>
+
+#define BITS 16
+
+volatile uint32_t total;
+volatile uint8_t readings;
+
+void gotReading(int32_t value) {    // called from the ADC interrupt
+  total += value;
+  readings++;
+}
+
+void setup() {
+  Serial.begin(115200);
+  analogReference(INTERNAL2V048);
+  ADCOversample.useTimer(TCB1);
+  if (!ADCOversample.begin(PIN_PD1, BITS, 50, gotReading)) {
+    Serial.println("Could not start");
+  }
+}
+
+void loop() {
+  static uint32_t lastPrint;
+  if (millis() - lastPrint >= 1000) {
+    lastPrint = millis();
+    uint8_t oldSREG = SREG;
+    cli();
+    uint32_t sum = total;
+    uint8_t n = readings;
+    total = 0;
+    readings = 0;
+    SREG = oldSREG;
+    if (n) {
+      uint32_t average = sum / n;
+      // 2048 mV full scale, so 2048000 uV is 2^BITS.
+      Serial.print((uint32_t)(((uint64_t) average * 2048000UL) >> BITS));
+      Serial.print(" uV, from ");
+      Serial.print(n);
+      Serial.println(" readings");
+    }
+  }
+}
@@ -0,0 +1,42 @@
+/* PWMSyncedSampling - take ADC readings at the same point in every PWM cycle, as you would to measure motor current.
+ *
+ * The current through a motor driven with PWM ramps up while the output is on and down while it's off, so a reading taken at
+ * a random moment is mostly noise. Taking it at the same point in each cycle fixes that - but starting the conversion from
+ * the timer's interrupt adds however long the interrupt took to get going, which varies. Here, the timer's underflow event
+ * starts the conversion directly, through the event system, so it happens at exactly the same point every time.
+ *
+ * TCA0 is in split mode (as the core sets it up for analogWrite()), and its low half underflows once per PWM cycle. With two
+ * channels, each underflow converts the next one, so PD1 and PD2 are each read every other cycle.
+ */
+#include <ADCStream.h>
+
+#define BLOCK_LEN 64                  // 32 readings of each channel
+
+int16_t bufA[BLOCK_LEN];
+int16_t bufB[BLOCK_LEN];
+const uint8_t channels[] = {PIN_PD1, PIN_PD2};
+
+void setup() {
+  Serial.begin(115200);
+  analogWrite(PIN_TCA0_WO0_INIT, 96); // PWM driving the motor, on the first TCA0 output pin
+  if (!ADCStream.beginOnEvent(event::gen::tca0_ovf_lunf, channels, 2, bufA, bufB, BLOCK_LEN)) {
+    Serial.println("Couldn't start ADCStream");
+    while (1);
+  }
+}
+
+void loop() {
+  int16_t *block = ADCStream.available();
+  if (block) {
+    int32_t sum1 = 0, sum2 = 0;
+    for (uint8_t i = 0; i < BLOCK_LEN; i += 2) {
+      sum1 += block[i];
+      sum2 += block[i + 1];
+    }
+    ADCStream.release();
+    Serial.print("PD1 avg: ");
+    Serial.print(sum1 / (BLOCK_LEN / 2));
+    Serial.print(" PD2 avg: ");
+    Serial.println(sum2 / (BLOCK_LEN / 2));
+  }
+}
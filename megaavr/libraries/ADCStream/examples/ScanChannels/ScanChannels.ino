@@ -0,0 +1,42 @@
+/* ScanChannels - read all the PORTD analog pins, 16 samples accumulated on each, from the ADC interrupt, while loop() keeps
+ * counting. Every half second, print the results and how far the count got while the scans were running - with
+ * analogReadEnh() in a loop, that count would be stuck at 0.
+ */
+#include <ADCScan.h>
+
+const uint8_t pins[] = {PIN_PD1, PIN_PD2, PIN_PD3, PIN_PD4, PIN_PD5, PIN_PD6, PIN_PD7};
+#define NUM_PINS (sizeof(pins) / sizeof(pins[0]))
+
+int32_t results[NUM_PINS];
+
+void setup() {
+  Serial.begin(115200);
+  analogReadResolution(12);
+  for (uint8_t i = 0; i < NUM_PINS; i++) {
+    ADCScan.add(pins[i], ADC_ACC16);
+  }
+  ADCScan.start(results, true);       // scan over and over until stopped.
+}
+
+void loop() {
+  static uint32_t lastPrint;
+  static uint32_t spins;
+  static uint16_t scans;
+  spins++;
+  if (ADCScan.done()) {
+    scans++;
+  }
+  if (millis() - lastPrint >= 500) {
+    lastPrint = millis();
+    for (uint8_t i = 0; i < NUM_PINS; i++) {
+      Serial.print(ADCScan.result(i) >> 4); // divide the sum of 16 by 16 to get the average.
+      Serial.print(' ');
+    }
+    Serial.print(" scans: ");
+    Serial.print(scans);
+    Serial.print(" loops: ");
+    Serial.println(spins);
+    scans = 0;
+    spins = 0;
+  }
+}
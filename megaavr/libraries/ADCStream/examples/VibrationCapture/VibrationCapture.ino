@@ -0,0 +1,49 @@
+/* VibrationCapture - capture an accelerometer (or any analog sensor) on PIN_PD1 at 8 ksps in blocks of 256 samples, and
+ * for each block, print the average and the peak-to-peak amplitude. While one block is being worked on, the ADC interrupt
+ * fills the other, so no samples are missed - unless printing can't keep up, which the overrun count will show.
+ */
+#include <ADCStream.h>
+
+#define BLOCK_LEN 256
+
+int16_t bufA[BLOCK_LEN];
+int16_t bufB[BLOCK_LEN];
+const uint8_t channels[] = {PIN_PD1};
+
+void setup() {
+  Serial.begin(115200);
+  analogReadResolution(12);
+  ADCStream.useTimer(TCB1);           // must not be the millis timer, which is TCB2 by default on most parts.
+  if (!ADCStream.begin(channels, 1, 8000, bufA, bufB, BLOCK_LEN)) {
+    Serial.println("Couldn't start ADCStream");
+    while (1);
+  }
+  Serial.print("Sampling at ");
+  Serial.print(ADCStream.rate());
+  Serial.println(" sps");
+}
+
+void loop() {
+  int16_t *block = ADCStream.available();
+  if (block) {
+    int32_t sum = 0;
+    int16_t lo = 4095, hi = 0;
+    for (uint16_t i = 0; i < BLOCK_LEN; i++) {
+      int16_t v = block[i];
+      sum += v;
+      if (v < lo) {
+        lo = v;
+      }
+      if (v > hi) {
+        hi = v;
+      }
+    }
+    ADCStream.release();                // done with the samples, so hand the buffer back right away.
+    Serial.print("avg ");
+    Serial.print(sum / BLOCK_LEN);
+    Serial.print(" p-p ");
+    Serial.print(hi - lo);
+    Serial.print(" overruns ");
+    Serial.println(ADCStream.overruns());
+  }
+}
@@ -0,0 +1,108 @@
+#include "ADCOversample.h"
+
+ADCOversampleClass ADCOversample;
+
+#if defined(ADCSTREAM_EX)
+  #define ADCOVERSAMPLE_BURST_LOG2 10   // ACC1024
+#else
+  #define ADCOVERSAMPLE_BURST_LOG2 4    // ACC16, the most 12-bit results that fit in RES without truncation.
+#endif
+
+bool ADCOversampleClass::begin(uint8_t pin, uint8_t bits, uint32_t rate, ADCOversampleCallback callback) {
+  end();
+  if (bits < ADCOVERSAMPLE_MIN_BITS || bits > ADCOVERSAMPLE_MAX_BITS || !(ADC0.CTRLA & ADC_ENABLE_bm)) {
+    return false;
+  }
+  if (rate && !_trigger.timerOK()) {
+    return false;
+  }
+  if (_adcBusy()) {
+    return false;
+  }
+  uint8_t muxpos = _adcMuxpos(pin);
+  if (muxpos == 0xFF) {
+    return false;
+  }
+  uint8_t shift   = bits - 12;
+  uint8_t total   = shift * 2;            // log2 of the number of samples per result
+  uint8_t sampnum = (total > ADCOVERSAMPLE_BURST_LOG2) ? ADCOVERSAMPLE_BURST_LOG2 : total;
+  _shift    = shift;
+  _bursts   = 1 << (total - sampnum);
+  _left     = _bursts;
+  _sum      = 0;
+  _result   = -1;
+  _new      = 0;
+  _callback = callback;
+  ADC0.MUXPOS = muxpos;
+  #if defined(ADCSTREAM_EX)
+    _oldctrl = ADC0.CTRLF;
+    ADC0.CTRLF = (_oldctrl & ~(ADC_SAMPNUM_gm | ADC_FREERUN_bm)) | sampnum | (rate ? 0 : ADC_FREERUN_bm);
+  #else
+    _oldctrl  = ADC0.CTRLB;
+    _oldctrla = ADC0.CTRLA;
+    ADC0.CTRLB = sampnum;
+    ADC0.CTRLA = (_oldctrla & ~ADC_RESSEL_gm) | ADC_RESSEL_12BIT_gc;
+  #endif
+  ADC0.INTFLAGS = ADC_RESRDY_bm;
+  ADC0.INTCTRL  = ADC_RESRDY_bm;
+  _running = 1;
+  if (rate) {
+    #if defined(ADCSTREAM_EX)
+      ADC0.COMMAND = ADC_MODE_BURST_gc | ADC_START_EVENT_TRIGGER_gc;
+    #else
+      ADC0.EVCTRL = ADC_STARTEI_bm;
+    #endif
+    if (rate > 0xFFFFFFFFUL / _bursts || !_trigger.startTimer(rate * _bursts)) {
+      end();
+      return false;
+    }
+  } else {
+    #if defined(ADCSTREAM_EX)
+      ADC0.COMMAND = ADC_MODE_BURST_gc | ADC_START_IMMEDIATE_gc;
+    #else
+      ADC0.CTRLA |= ADC_FREERUN_bm;
+      ADC0.COMMAND = ADC_STCONV_bm;
+    #endif
+  }
+  return true;
+}
+
+void ADCOversampleClass::end() {
+  if (!_running) {
+    return;
+  }
+  _trigger.stop();
+  _adcStop();
+  #if defined(ADCSTREAM_EX)
+    ADC0.CTRLF = _oldctrl;
+  #else
+    ADC0.CTRLB = _oldctrl;
+    ADC0.CTRLA = _oldctrla;
+  #endif
+  #if (defined(ERRATA_ADC_PIN_DISABLE) && ERRATA_ADC_PIN_DISABLE != 0)
+    ADC0.MUXPOS = 0x40;
+  #endif
+  _running = 0;
+}
+
+ISR(ADC0_RESRDY_vect) {
+  ADCOversampleClass &o = ADCOversample;
+  #if defined(ADCSTREAM_EX)
+    uint32_t sum = o._sum + ADC0.RESULT;
+    ADC0.INTFLAGS = ADC_RESRDY_bm;
+  #else
+    uint32_t sum = o._sum + ADC0.RES;
+  #endif
+  if (--o._left) {
+    o._sum = sum;
+    return;
+  }
+  o._left = o._bursts;
+  o._sum  = 0;
+  int32_t value = sum >> o._shift;
+  o._result = value;
+  o._new    = 1;
+  if (o._callback) {
+    o._callback(value);
+  }
+}
@@ -0,0 +1,96 @@
+/* ADCOversample.h - oversampling and decimation from the ADC interrupt, for readings with more resolution than the ADC has,
+ * at a steady rate, without blocking, for DxCore.
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * Each extra bit of resolution takes 4 times as many samples: the sum of 4^n 12-bit samples, shifted right by n, is a
+ * 12+n bit result (provided there's enough noise on the signal to dither it - there usually is). analogReadEnh() does this
+ * with the accumulator, but only up to what one burst can hold, and it waits for the whole burst. Here, the hardware
+ * accumulates a burst, and the interrupt adds up as many bursts as it takes, so the CPU is only interrupted once per burst,
+ * and is free in between.
+ *
+ * The Dx-series accumulator is only 16 bits, so a burst is at most 16 samples at 12 bits before it starts throwing away the
+ * low bits; the Ex-series one is 32 bits, so we can let it take up to 1024 at a time.
+ *
+ * The bursts are started by a TCB, at the output rate times the number of bursts per result, or if the rate is 0, back to
+ * back, as fast as the ADC can go.
+ *
+ * The interrupt is in ADCOversample.cpp, which is only linked in if ADCOversample is used. Only one of the classes in this
+ * library that use the ADC interrupt can be used in a sketch.
+ */
+
+#ifndef ADCOVERSAMPLE_H
+#define ADCOVERSAMPLE_H
+#include <Arduino.h>
+#include <Event.h>
+#include "ADCStream_hw.h"
+#include "ADCTrigger.h"
+
+#define ADCOVERSAMPLE_MIN_BITS 13
+#define ADCOVERSAMPLE_MAX_BITS 20   // 4^8 12-bit samples is as many as a 32-bit sum can hold.
+
+// Called from the ADC interrupt with each result. Keep it short.
+typedef void (*ADCOversampleCallback)(int32_t value);
+
+class ADCOversampleClass {
+  public:
+    ADCOversampleClass() {}
+    // The TCB used to pace the bursts when rate is not 0. It must not be the millis timer. Call before begin().
+    void useTimer(TCB_t &timer) {
+      _trigger.useTimer(timer);
+    }
+    /* Start taking readings of pin (or ADC_CH() channel) with bits of resolution (13 to 20), rate times a second, or as fast
+     * as possible if rate is 0. callback may be NULL if you'd rather poll available(). Returns false if an argument is out of
+     * range, if a timer is needed and useTimer() hasn't been called (or was given the millis timer), if no event channel is
+     * free, if the timer can't make the rate, or if the ADC is disabled or busy. */
+    bool begin(uint8_t pin, uint8_t bits, uint32_t rate, ADCOversampleCallback callback = NULL);
+    void end();
+    // True once for each new result.
+    bool available() {
+      if (_new) {
+        _new = 0;
+        return true;
+      }
+      return false;
+    }
+    // The latest result, or -1 if there hasn't been one yet.
+    int32_t read() {
+      uint8_t oldSREG = SREG;
+      cli();
+      int32_t value = _result;
+      SREG = oldSREG;
+      return value;
+    }
+    // The output rate actually used (the closest the timer can do), or 0 if the ADC is free running.
+    uint32_t rate() {
+      return _trigger.rate() / _bursts;
+    }
+    // The number of samples added up for each result: 4^(bits - 12).
+    uint32_t samples() {
+      return 1UL << (_shift * 2);
+    }
+    bool running() {
+      return _running;
+    }
+
+    // Used by the ISR. Not for sketches.
+    volatile uint8_t      _running  = 0;
+    volatile uint8_t      _new      = 0;
+    uint8_t               _shift    = 0;
+    uint16_t              _bursts   = 1;
+    uint16_t              _left     = 0;
+    uint32_t              _sum      = 0;
+    volatile int32_t      _result   = -1;
+    ADCOversampleCallback _callback = NULL;
+
+  private:
+    ADCTrigger _trigger;
+    uint8_t    _oldctrl  = 0;  // CTRLB (Dx) or CTRLF (Ex), which we change, to put back when we're done.
+    #if !defined(ADCSTREAM_EX)
+      uint8_t  _oldctrla = 0;  // and CTRLA on Dx, for the resolution.
+    #endif
+};
+
+extern ADCOversampleClass ADCOversample;
+
+#endif
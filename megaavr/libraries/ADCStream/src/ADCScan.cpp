@@ -0,0 +1,156 @@
+#include "ADCScan.h"
+
+ADCScanClass ADCScan;
+
+// Set the ADC up for one channel and start the conversion.
+static inline void loadEntry(const ADCScanEntry &e) {
+  #if defined(ADCSTREAM_EX)
+    if (e.pgactrl) {
+      ADC0.PGACTRL = e.pgactrl;
+    }
+    ADC0.MUXPOS  = e.muxpos;
+    ADC0.CTRLF   = e.sampnum;
+    ADC0.CTRLE   = e.sampdur;
+    ADC0.COMMAND = e.command;
+  #else
+    ADC0.MUXPOS   = e.muxpos;
+    ADC0.CTRLB    = e.sampnum;
+    ADC0.SAMPCTRL = e.sampdur;
+    ADC0.COMMAND  = ADC_STCONV_bm;
+  #endif
+}
+
+int8_t ADCScanClass::add(uint8_t pin, uint8_t accumulate, int16_t sampleDuration, uint8_t gain) {
+  if (_running || _count >= ADCSCAN_MAX_CHANNELS) {
+    return -1;
+  }
+  uint8_t muxpos = _adcMuxpos(pin);
+  if (muxpos == 0xFF) {
+    return -1;
+  }
+  uint8_t sampnum = 0;
+  if (accumulate) {
+    sampnum = accumulate & 0x7F;
+    #if defined(ADCSTREAM_EX)
+      if (!(accumulate & 0x80) || sampnum > 10) {
+    #else
+      if (!(accumulate & 0x80) || sampnum > 7) {
+    #endif
+      return -1;
+    }
+  }
+  ADCScanEntry &e = _list[_count];
+  #if defined(ADCSTREAM_EX)
+    e.pgactrl = 0;
+    if (gain) {
+      uint8_t gainbits = 0;
+      while (gain > 1) {
+        if (gain & 1) {
+          return -1;          // not a power of 2
+        }
+        gain >>= 1;
+        gainbits += 32;
+      }
+      if (gainbits > 0x80) {  // 16x is the most
+        return -1;
+      }
+      e.pgactrl = (ADC0.PGACTRL & ~ADC_GAIN_gm) | gainbits | ADC_PGAEN_bm;
+      muxpos |= ADC_VIA_PGA_gc;
+      _pga = 1;
+    }
+    e.sampnum = (ADC0.CTRLF & ~(ADC_SAMPNUM_gm | ADC_FREERUN_bm)) | sampnum;
+    e.sampdur = (sampleDuration < 0) ? ADC0.CTRLE : (uint8_t) sampleDuration;
+    e.command = (sampnum ? ADC_MODE_BURST_gc : _adcSingleMode()) | ADC_START_IMMEDIATE_gc;
+    e.shift   = sampnum ? 0 : _adcResultShift();
+  #else
+    if (gain) {
+      return -1;              // No PGA on Dx-series parts
+    }
+    e.sampnum = sampnum;
+    e.sampdur = (sampleDuration < 0) ? ADC0.SAMPCTRL : (uint8_t) sampleDuration;
+  #endif
+  e.muxpos = muxpos;
+  return _count++;
+}
+
+void ADCScanClass::clear() {
+  if (!_running) {
+    _count = 0;
+    #if defined(ADCSTREAM_EX)
+      _pga = 0;
+    #endif
+  }
+}
+
+bool ADCScanClass::start(int32_t *results, bool continuous) {
+  if (_running || _count == 0 || results == NULL || !(ADC0.CTRLA & ADC_ENABLE_bm) || _adcBusy()) {
+    return false;
+  }
+  #if defined(ADCSTREAM_EX)
+    _oldsampnum = ADC0.CTRLF;
+    _oldsampdur = ADC0.CTRLE;
+  #else
+    _oldsampnum = ADC0.CTRLB;
+    _oldsampdur = ADC0.SAMPCTRL;
+  #endif
+  _results    = results;
+  _continuous = continuous;
+  _index      = 0;
+  _done       = 0;
+  _running    = 1;
+  ADC0.INTFLAGS = ADC_RESRDY_bm;
+  ADC0.INTCTRL  = ADC_RESRDY_bm;
+  loadEntry(_list[0]);
+  return true;
+}
+
+// Put back what start() changed. Called with interrupts off, with no conversion in progress.
+void ADCScanClass::_finish() {
+  ADC0.INTCTRL = 0;
+  #if defined(ADCSTREAM_EX)
+    ADC0.CTRLF = _oldsampnum;
+    ADC0.CTRLE = _oldsampdur;
+    if (_pga) {
+      ADC0.PGACTRL &= ~ADC_PGAEN_bm;
+    }
+  #else
+    ADC0.CTRLB    = _oldsampnum;
+    ADC0.SAMPCTRL = _oldsampdur;
+  #endif
+  #if (defined(ERRATA_ADC_PIN_DISABLE) && ERRATA_ADC_PIN_DISABLE != 0)
+    ADC0.MUXPOS = 0x40;
+  #endif
+  _running = 0;
+}
+
+void ADCScanClass::stop() {
+  uint8_t oldSREG = SREG;
+  cli();
+  if (_running) {
+    _adcStop();
+    _finish();
+  }
+  SREG = oldSREG;
+}
+
+ISR(ADC0_RESRDY_vect) {
+  ADCScanClass &s = ADCScan;
+  uint8_t i = s._index;
+  #if defined(ADCSTREAM_EX)
+    int32_t r = ADC0.RESULT;
+    ADC0.INTFLAGS = ADC_RESRDY_bm;
+    s._results[i] = r >> s._list[i].shift;
+  #else
+    s._results[i] = ADC0.RES;
+  #endif
+  if (++i == s._count) {
+    i = 0;
+    s._done = 1;
+    if (!s._continuous) {
+      s._finish();
+      return;
+    }
+  }
+  s._index = i;
+  loadEntry(s._list[i]);
+}
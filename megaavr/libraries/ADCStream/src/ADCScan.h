@@ -0,0 +1,97 @@
+/* ADCScan.h - read a list of ADC channels back to back from the ADC interrupt, for DxCore
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * Reading a dozen channels with analogReadEnh() means a dozen rounds of checking the arguments, working out the register
+ * values, writing them, and waiting. Here, the register values for each channel are worked out once, by add(). start() loads
+ * the first and starts a conversion, and from then on, the ADC interrupt stores each result, loads the next channel's settings
+ * and starts it, with no checking and no waiting. When the whole list has been read, done() returns true. The sketch can do
+ * other work the whole time.
+ *
+ * The interrupt is in ADCScan.cpp, which is only linked in if ADCScan is used. It can't be used in the same sketch as
+ * ADCStream, since they both need the ADC interrupt.
+ */
+
+#ifndef ADCSCAN_H
+#define ADCSCAN_H
+#include <Arduino.h>
+#include "ADCStream_hw.h"
+
+#define ADCSCAN_MAX_CHANNELS 16
+
+// The register values for one channel, as worked out by add().
+typedef struct {
+  uint8_t muxpos;
+  uint8_t sampnum;     // CTRLB (Dx) or CTRLF (Ex)
+  uint8_t sampdur;     // SAMPCTRL (Dx) or CTRLE (Ex)
+  #if defined(ADCSTREAM_EX)
+    uint8_t command;   // conversion mode and start bits
+    uint8_t pgactrl;   // 0 if not using the PGA
+    uint8_t shift;     // to turn the 12-bit result into a 10-bit one, when that's the analogRead() resolution.
+  #endif
+} ADCScanEntry;
+
+class ADCScanClass {
+  public:
+    ADCScanClass() {}
+    /* Add a channel to the end of the list. pin is a pin or ADC_CH() channel. accumulate is 0, or ADC_ACC2 through ADC_ACC128
+     * (ADC_ACC1024 on Ex-series) to accumulate that many samples, as analogReadEnh() does. sampleDuration is the sample
+     * duration, as for analogSampleDuration(), or -1 to use whatever that is when add() is called. gain is the PGA gain,
+     * 0 (no PGA), 1, 2, 4, 8 or 16, and only the Ex-series has a PGA. The reference is not part of it: all channels use the
+     * one set with analogReference(), since changing the reference means waiting for it to settle.
+     * Returns the channel's index in the list and in the results, or -1 if the list is full, the scan is running, or an
+     * argument is invalid. */
+    int8_t add(uint8_t pin, uint8_t accumulate = 0, int16_t sampleDuration = -1, uint8_t gain = 0);
+    // Empty the list. Not while a scan is running.
+    void clear();
+    /* Start reading the list into results, which must have room for count() values. Each is what analogRead() would give,
+     * or with accumulation, the sum that analogReadEnh() would give for ADC_ACCn. If continuous is true, the scan starts over
+     * as soon as it finishes, until stop() is called. Returns false if the list is empty, a scan is running, or the ADC is
+     * disabled or busy. */
+    bool start(int32_t *results, bool continuous = false);
+    // Stop a continuous scan (or abandon a single one). Returns once the ADC is back the way analogRead() expects.
+    void stop();
+    // True if the list has been read completely since start() or the last time done() returned true.
+    bool done() {
+      if (_done) {
+        _done = 0;
+        return true;
+      }
+      return false;
+    }
+    // One result, read with interrupts off so a continuous scan can't change it half way through.
+    int32_t result(uint8_t index) {
+      uint8_t oldSREG = SREG;
+      cli();
+      int32_t r = _results[index];
+      SREG = oldSREG;
+      return r;
+    }
+    bool running() {
+      return _running;
+    }
+    uint8_t count() {
+      return _count;
+    }
+
+    // Used by the ISR. Not for sketches.
+    void _finish();
+    volatile uint8_t  _running    = 0;
+    volatile uint8_t  _done       = 0;
+    uint8_t           _continuous = 0;
+    uint8_t           _index      = 0;
+    uint8_t           _count      = 0;
+    int32_t *volatile _results    = NULL;
+    ADCScanEntry      _list[ADCSCAN_MAX_CHANNELS];
+
+  private:
+    uint8_t _oldsampnum = 0;
+    uint8_t _oldsampdur = 0;
+    #if defined(ADCSTREAM_EX)
+      uint8_t _pga      = 0;  // set if any channel uses the PGA, so we turn it off after.
+    #endif
+};
+
+extern ADCScanClass ADCScan;
+
+#endif
@@ -0,0 +1,136 @@
+#include "ADCStream.h"
+
+ADCStreamClass ADCStream;
+
+// Check the arguments, and set up the state and everything about the ADC except how conversions are started.
+bool ADCStreamClass::_setup(const uint8_t *channels, uint8_t count, int16_t *bufA, int16_t *bufB, uint16_t length, ADCBlockCallback callback) {
+  if (count == 0 || count > ADCSTREAM_MAX_CHANNELS || bufA == NULL || bufB == NULL || length == 0 || (length % count)) {
+    return false;
+  }
+  if (!(ADC0.CTRLA & ADC_ENABLE_bm) || _adcBusy()) {
+    return false;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t muxpos = _adcMuxpos(channels[i]);
+    if (muxpos == 0xFF) {
+      return false;
+    }
+    _channels[i] = muxpos;
+  }
+  _count    = count;
+  _index    = 0;
+  _buf[0]   = bufA;
+  _buf[1]   = bufB;
+  _length   = length;
+  _pos      = 0;
+  _fill     = 0;
+  _ready    = NULL;
+  _overruns = 0;
+  _callback = callback;
+  _shift    = _adcResultShift();
+  #if defined(ADCSTREAM_EX)
+    _oldctrl = ADC0.CTRLF;
+  #else
+    _oldctrl = ADC0.CTRLB;
+  #endif
+  ADC0.MUXPOS   = _channels[0];
+  ADC0.INTFLAGS = ADC_RESRDY_bm;
+  ADC0.INTCTRL  = ADC_RESRDY_bm;
+  _running = 1;
+  return true;
+}
+
+bool ADCStreamClass::begin(const uint8_t *channels, uint8_t count, uint32_t rate, int16_t *bufA, int16_t *bufB, uint16_t length, ADCBlockCallback callback) {
+  end();
+  if (rate == 0 && count > 1) {
+    return false;
+  }
+  if (rate && !_trigger.timerOK()) {
+    return false;
+  }
+  if (!_setup(channels, count, bufA, bufB, length, callback)) {
+    return false;
+  }
+  if (rate) {
+    _adcStartOnEvent(_adcSingleMode());
+    if (!_trigger.startTimer(rate)) {
+      end();
+      return false;
+    }
+  } else {
+    _adcStartFreeRun(_adcSingleMode());
+  }
+  return true;
+}
+
+bool ADCStreamClass::beginOnEvent(event::gen::generator_t trigger, const uint8_t *channels, uint8_t count, int16_t *bufA, int16_t *bufB, uint16_t length, ADCBlockCallback callback) {
+  end();
+  if (!_setup(channels, count, bufA, bufB, length, callback)) {
+    return false;
+  }
+  _adcStartOnEvent(_adcSingleMode());
+  if (!_trigger.route(trigger)) {
+    end();
+    return false;
+  }
+  return true;
+}
+
+void ADCStreamClass::end() {
+  if (!_running) {
+    return;
+  }
+  _trigger.stop();
+  _adcStop();
+  #if defined(ADCSTREAM_EX)
+    ADC0.CTRLF = _oldctrl & ~ADC_FREERUN_bm;
+  #else
+    ADC0.CTRLB = _oldctrl;
+  #endif
+  #if (defined(ERRATA_ADC_PIN_DISABLE) && ERRATA_ADC_PIN_DISABLE != 0)
+    ADC0.MUXPOS = 0x40;
+  #endif
+  _running = 0;
+  _ready = NULL;
+}
+
+uint16_t ADCStreamClass::overruns() {
+  uint8_t oldSREG = SREG;
+  cli();
+  uint16_t n = _overruns;
+  SREG = oldSREG;
+  return n;
+}
+
+ISR(ADC0_RESRDY_vect) {
+  ADCStreamClass &s = ADCStream;
+  int16_t value = _adcResult();
+  #if defined(ADCSTREAM_EX)
+    ADC0.INTFLAGS = ADC_RESRDY_bm;
+    value >>= s._shift;
+  #endif
+  if (s._count > 1) {             // The next conversion hasn't been triggered yet, so point it at the next channel.
+    uint8_t i = s._index + 1;
+    if (i == s._count) {
+      i = 0;
+    }
+    s._index = i;
+    ADC0.MUXPOS = s._channels[i];
+  }
+  uint16_t pos = s._pos;
+  s._buf[s._fill][pos++] = value;
+  if (pos == s._length) {
+    pos = 0;
+    if (s._ready) {               // The sketch still has the other buffer, so we have to fill this one again.
+      s._overruns++;
+    } else {
+      int16_t *full = s._buf[s._fill];
+      s._fill ^= 1;
+      s._ready = full;
+      if (s._callback) {
+        s._callback(full, s._length);
+      }
+    }
+  }
+  s._pos = pos;
+}
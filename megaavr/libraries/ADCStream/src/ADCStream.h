@@ -0,0 +1,101 @@
+/* ADCStream.h - continuous interrupt driven ADC sampling into a pair of buffers, for DxCore
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * The ADC result ready interrupt stores each result in one buffer. When that buffer is full, it is handed to the sketch,
+ * and the interrupt carries on filling the other one. The sketch has until the second buffer fills to finish with the first
+ * and release() it. If it hasn't, the block being filled is thrown away and filled again, and overruns() counts it, so the
+ * sketch never sees a block that was overwritten while it was looking at it.
+ *
+ * Conversions are either started by a TCB, at a fixed rate, or if the rate is 0 and there is only one channel, the ADC runs
+ * in free running mode, starting each conversion as soon as the last one is done. With more than one channel, the interrupt
+ * selects the next channel after each conversion, so the channels are interleaved in the buffers: with 3 channels, the block
+ * holds ch0, ch1, ch2, ch0, ch1, ch2... That needs a timer, since in free running mode the next conversion is already under
+ * way by the time the interrupt could change channels.
+ *
+ * Or, with beginOnEvent(), each conversion is started by an event from some other peripheral - say, a TCA or TCD at a
+ * particular point in the PWM cycle. Since the event system starts the conversion directly, there is none of the jitter of
+ * starting it from an interrupt.
+ *
+ * The interrupt is in ADCStream.cpp, which is only linked in if ADCStream is used. Only one of the classes in this library
+ * that use the ADC interrupt can be used in a sketch.
+ */
+
+#ifndef ADCSTREAM_H
+#define ADCSTREAM_H
+#include <Arduino.h>
+#include <Event.h>
+#include "ADCStream_hw.h"
+#include "ADCTrigger.h"
+
+#define ADCSTREAM_MAX_CHANNELS 16
+
+// Called from the ADC interrupt each time a block is full. Keep it short - the next sample is only one sample period away.
+typedef void (*ADCBlockCallback)(int16_t *block, uint16_t length);
+
+class ADCStreamClass {
+  public:
+    ADCStreamClass() {}
+    // The TCB used to time the conversions when rate is not 0. It must not be the millis timer. Call before begin().
+    void useTimer(TCB_t &timer) {
+      _trigger.useTimer(timer);
+    }
+    /* Start sampling. channels are pins or ADC_CH() channels, count of them. rate is in samples per second, for all channels
+     * together, or 0 for free running (one channel only). bufA and bufB are each length samples long, and length must be a
+     * multiple of count. callback may be NULL if you'd rather poll available(). Returns false if any of that isn't true, if
+     * a timer is needed and useTimer() hasn't been called (or was given the millis timer), if no event channel is free, if
+     * the rate can't be generated, or if the ADC is disabled or busy. Samples are at the resolution set with analogReadResolution(). */
+    bool begin(const uint8_t *channels, uint8_t count, uint32_t rate, int16_t *bufA, int16_t *bufB, uint16_t length, ADCBlockCallback callback = NULL);
+    /* As begin(), but each conversion is started by the event generator trigger, such as event::gen::tca0_ovf_lunf or
+     * Event::gen_from_peripheral(TCA0, 1). With more than one channel, each event converts the next channel. If the
+     * generator is already on an event channel, that channel is used; otherwise, a free one is. useTimer() is not needed. */
+    bool beginOnEvent(event::gen::generator_t trigger, const uint8_t *channels, uint8_t count, int16_t *bufA, int16_t *bufB, uint16_t length, ADCBlockCallback callback = NULL);
+    void end();
+    // The full block that hasn't been released yet, or NULL if there isn't one.
+    int16_t *available() {
+      uint8_t oldSREG = SREG;
+      cli();                    // a pointer is two bytes, and the ISR could change it between them.
+      int16_t *block = _ready;
+      SREG = oldSREG;
+      return block;
+    }
+    // Call when done with the block from available() or the callback, so that the buffer can be filled again.
+    void release() {
+      uint8_t oldSREG = SREG;
+      cli();                    // and if it ran between the two bytes here, it would see a block that isn't there.
+      _ready = NULL;
+      SREG = oldSREG;
+    }
+    // Number of blocks thrown away because the previous block hadn't been released when they were full.
+    uint16_t overruns();
+    // The sample rate actually used (the closest the timer can do), or 0 in free running mode or with beginOnEvent().
+    uint32_t rate() {
+      return _trigger.rate();
+    }
+    bool running() {
+      return _running;
+    }
+
+    // Used by the ISR. Not for sketches.
+    volatile uint8_t  _running    = 0;
+    volatile uint8_t  _fill       = 0;
+    uint8_t           _count      = 0;
+    uint8_t           _index      = 0;
+    uint8_t           _shift      = 0;
+    uint16_t          _length     = 0;
+    uint16_t          _pos        = 0;
+    volatile uint16_t _overruns   = 0;
+    int16_t          *_buf[2]     = {NULL, NULL};
+    int16_t *volatile _ready      = NULL;
+    ADCBlockCallback  _callback   = NULL;
+    uint8_t           _channels[ADCSTREAM_MAX_CHANNELS];
+
+  private:
+    bool _setup(const uint8_t *channels, uint8_t count, int16_t *bufA, int16_t *bufB, uint16_t length, ADCBlockCallback callback);
+    ADCTrigger _trigger;
+    uint8_t    _oldctrl = 0;  // CTRLB (Dx) or CTRLF (Ex), which we change, to put back when we're done.
+};
+
+extern ADCStreamClass ADCStream;
+
+#endif
@@ -0,0 +1,94 @@
+/* ADCStream_hw.h - the few pieces of the ADC that differ between the Dx-series and Ex-series, for the interrupt driven ADC
+ * classes in this library. Not meant to be included by sketches.
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * Dx-series: the resolution (10 or 12 bits) is set by RESSEL in CTRLA, which analogReadResolution() sets, so we leave it be.
+ * A conversion is started by STCONV, by an event if STARTEI is set, or by the last one finishing if FREERUN is set.
+ * Ex-series: the resolution and accumulation mode are given with each start command. 10-bit "resolution" is really 12 bits
+ * shifted down, as analogRead() does it. The start command also selects the trigger: immediate, or on event.
+ */
+
+#ifndef ADCSTREAM_HW_H
+#define ADCSTREAM_HW_H
+#include <Arduino.h>
+
+#if defined(ADC0_TEMP2)
+  #define ADCSTREAM_EX 1
+#elif defined(ADC_LOWLAT_bm)
+  #error "The ADCStream library does not support the AVR DU-series ADC yet."
+#endif
+
+// The MUXPOS value for a digital pin, or for an ADC_CH() channel. Returns 0xFF if the pin has no analog input.
+static inline uint8_t _adcMuxpos(uint8_t pin) {
+  if (pin & 0x80) {
+    return pin & 0x7F;
+  }
+  pin = digitalPinToAnalogInput(pin);
+  return (pin == NOT_A_PIN) ? 0xFF : pin;
+}
+
+#if defined(ADCSTREAM_EX)
+  // True if a conversion is under way, or a result from analogReadStart() and friends hasn't been collected yet.
+  static inline bool _adcBusy() {
+    return (ADC0.COMMAND & ADC_START_gm) || analogReadPending();
+  }
+  // The COMMAND value for single conversions at the analogRead() resolution, minus the start bits.
+  static inline uint8_t _adcSingleMode() {
+    return (getAnalogReadResolution() == 8) ? ADC_MODE_SINGLE_8BIT_gc : ADC_MODE_SINGLE_12BIT_gc;
+  }
+  // How far to shift results right to get the analogRead() resolution.
+  static inline uint8_t _adcResultShift() {
+    return (getAnalogReadResolution() == 10) ? 2 : 0;
+  }
+  static inline void _adcStartFreeRun(uint8_t mode) {
+    ADC0.CTRLF = (ADC0.CTRLF & ~ADC_SAMPNUM_gm) | ADC_FREERUN_bm;
+    ADC0.COMMAND = mode | ADC_START_IMMEDIATE_gc;
+  }
+  static inline void _adcStartOnEvent(uint8_t mode) {
+    ADC0.CTRLF &= ~(ADC_SAMPNUM_gm | ADC_FREERUN_bm);
+    ADC0.COMMAND = mode | ADC_START_EVENT_TRIGGER_gc;
+  }
+  static inline void _adcStop() {
+    ADC0.COMMAND = ADC_START_STOP_gc;
+    ADC0.CTRLF &= ~ADC_FREERUN_bm;
+    ADC0.INTCTRL = 0;
+    ADC0.INTFLAGS = ADC_RESRDY_bm;
+  }
+  static inline int16_t _adcResult() {
+    return (int16_t) ADC0.RESULT;
+  }
+#else
+  static inline bool _adcBusy() {
+    return (ADC0.COMMAND & ADC_STCONV_bm) || (ADC0.CTRLA & ADC_FREERUN_bm) || analogReadPending();
+  }
+  static inline uint8_t _adcSingleMode() {
+    return 0;
+  }
+  static inline uint8_t _adcResultShift() {
+    return 0;
+  }
+  static inline void _adcStartFreeRun(__attribute__((unused)) uint8_t mode) {
+    ADC0.CTRLB = 0;                         // No accumulation
+    ADC0.EVCTRL = 0;
+    ADC0.CTRLA |= ADC_FREERUN_bm;
+    ADC0.COMMAND = ADC_STCONV_bm;
+  }
+  static inline void _adcStartOnEvent(__attribute__((unused)) uint8_t mode) {
+    ADC0.CTRLB = 0;
+    ADC0.CTRLA &= ~ADC_FREERUN_bm;
+    ADC0.EVCTRL = ADC_STARTEI_bm;
+  }
+  static inline void _adcStop() {
+    ADC0.EVCTRL = 0;
+    ADC0.CTRLA &= ~ADC_FREERUN_bm;
+    ADC0.COMMAND = ADC_SPCONV_bm;
+    ADC0.INTCTRL = 0;
+    ADC0.INTFLAGS = ADC_RESRDY_bm;
+  }
+  static inline int16_t _adcResult() {
+    return ADC0.RES;
+  }
+#endif
+
+#endif
@@ -0,0 +1,81 @@
+#include "ADCTrigger.h"
+
+bool ADCTrigger::timerOK() {
+  if (_timer == NULL) {
+    return false;
+  }
+  #if defined(MILLIS_USE_TCB)
+    return (MILLIS_TIMER - TIMERB0) != (uint8_t)(_timer - &TCB0);
+  #else
+    return true;
+  #endif
+}
+
+bool ADCTrigger::route(event::gen::generator_t generator) {
+  _ownEvent = (Event::get_generator_channel(generator).get_channel_number() == 255);
+  Event &channel = Event::assign_generator(generator);
+  if (channel.get_channel_number() == 255) {
+    return false;                                   // Every channel is in use.
+  }
+  channel.set_user(event::user::adc0_start);
+  channel.start();
+  _event = &channel;
+  return true;
+}
+
+/* Set the TCB up in periodic interrupt mode (without the interrupt), and route its CAPT event, which it generates every
+ * period, to the ADC start input. We use the fastest clock that can count the whole period: the system clock, half of it,
+ * or whatever TCA0 is prescaled to. */
+bool ADCTrigger::startTimer(uint32_t rate) {
+  if (rate == 0 || !timerOK()) {
+    return false;
+  }
+  uint8_t  clksel = TCB_CLKSEL_DIV1_gc;
+  uint32_t clock  = F_CPU;
+  uint32_t top    = (clock + rate / 2) / rate;
+  if (top > 0x10000UL) {
+    clksel = TCB_CLKSEL_DIV2_gc;
+    clock  = F_CPU / 2;
+    top    = (clock + rate / 2) / rate;
+  }
+  #if defined(TCA0)
+    if (top > 0x10000UL) {
+      static const uint16_t tca_div[8] = {1, 2, 4, 8, 16, 64, 256, 1024};
+      clksel = TCB_CLKSEL_TCA0_gc;
+      clock  = F_CPU / tca_div[(TCA0.SINGLE.CTRLA & TCA_SINGLE_CLKSEL_gm) >> TCA_SINGLE_CLKSEL_gp];
+      top    = (clock + rate / 2) / rate;
+    }
+  #endif
+  if (top > 0x10000UL || top < 2) {
+    return false;
+  }
+  TCB_t &timer = *_timer;
+  timer.CTRLA = 0;
+  if (!route(Event::gen_from_peripheral(timer, 0))) { // 0 = CAPT
+    return false;
+  }
+  timer.CTRLB    = TCB_CNTMODE_INT_gc;
+  timer.EVCTRL   = 0;
+  timer.INTCTRL  = 0;
+  timer.INTFLAGS = TCB_CAPT_bm | TCB_OVF_bm;
+  timer.CNT      = 0;
+  timer.CCMP     = top - 1;
+  _rate = clock / top;
+  timer.CTRLA = clksel | TCB_ENABLE_bm;
+  return true;
+}
+
+void ADCTrigger::stop() {
+  if (_rate) {
+    _timer->CTRLA = 0;
+    _rate = 0;
+  }
+  if (_event) {
+    Event::clear_user(event::user::adc0_start);
+    if (_ownEvent) {
+      _event->stop();
+      _event->set_generator(event::gen::disable);
+    }
+    _event = NULL;
+  }
+}
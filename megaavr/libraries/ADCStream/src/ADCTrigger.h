@@ -0,0 +1,40 @@
+/* ADCTrigger.h - starting ADC conversions through the event system, either from a TCB at a fixed rate, or from some other
+ * event generator, for the interrupt driven ADC classes in this library. Not meant to be included by sketches.
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * The ADC must already be set to start a conversion on an event (STARTEI on Dx, an event trigger start command on Ex);
+ * this only gets the events to it.
+ */
+
+#ifndef ADCTRIGGER_H
+#define ADCTRIGGER_H
+#include <Arduino.h>
+#include <Event.h>
+
+class ADCTrigger {
+  public:
+    void useTimer(TCB_t &timer) {
+      _timer = &timer;
+    }
+    // True if useTimer() has been called with a TCB that isn't the millis timer.
+    bool timerOK();
+    // Run the TCB at rate per second (the nearest it can do), and route its CAPT event to the ADC.
+    bool startTimer(uint32_t rate);
+    // Route generator to the ADC. If it's already on an event channel, that channel is used, otherwise a free one is.
+    bool route(event::gen::generator_t generator);
+    // Stop the timer if we started it, disconnect the ADC, and free the channel if we took it.
+    void stop();
+    // The rate startTimer() actually got, or 0 if the timer isn't running.
+    uint32_t rate() {
+      return _rate;
+    }
+
+  private:
+    TCB_t    *_timer    = NULL;
+    Event    *_event    = NULL;
+    bool      _ownEvent = false;  // true if we took a free channel, rather than sharing one the generator was already on.
+    uint32_t  _rate     = 0;
+};
+
+#endif
@@ -0,0 +1,48 @@
+/* BinaryLogDemo - logs a few values both ways, so you can compare the cost.
+ *
+ * BinaryLog sends the address of the format string and the raw argument bytes; nothing is formatted on the chip. To read
+ * the output, export the compiled binary (Sketch -> Export compiled binary), then on the computer run:
+ *
+ *   python3 binlog_decode.py BinaryLogDemo.ino.elf -p <port> -b 115200
+ *
+ * binlog_decode.py is in the tools directory of the core. Ordinary Serial output passes straight through the decoder, so
+ * the timing lines printed with Serial.print() show up as normal.
+ */
+#include <BinaryLog.h>
+
+BinaryLog logger(Serial);
+
+void setup() {
+  Serial.begin(115200);
+  logger.log(F("BinaryLogDemo starting, F_CPU = %lu\n"), F_CPU);
+}
+
+void loop() {
+  static uint16_t count = 0;
+  int16_t reading = analogRead(A0);
+  float volts = reading * (3.3 / 1023.0);
+
+  uint32_t start = micros();
+  logger.log(F("%u: A0 = %d (%.3f V) %S\n"), count, reading, volts, reading > 512 ? F("high") : F("low"));
+  uint32_t binaryTime = micros() - start;
+  Serial.flush();
+
+  start = micros();
+  Serial.print(count);
+  Serial.print(": A0 = ");
+  Serial.print(reading);
+  Serial.print(" (");
+  Serial.print(volts, 3);
+  Serial.print(" V) ");
+  Serial.println(reading > 512 ? F("high") : F("low"));
+  uint32_t printTime = micros() - start;
+  Serial.flush();
+
+  Serial.print("log() took ");
+  Serial.print(binaryTime);
+  Serial.print(" us, print() took ");
+  Serial.print(printTime);
+  Serial.println(" us");
+  count++;
+  delay(1000);
+}
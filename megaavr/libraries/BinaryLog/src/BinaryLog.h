@@ -0,0 +1,81 @@
+/* BinaryLog.h - Deferred formatting logger for DxCore
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * Instead of formatting the text on the chip, we send the address of the format string (which must be in flash - use F()),
+ * followed by the raw bytes of each argument, and the host-side decoder (megaavr/tools/binlog_decode.py) looks the format
+ * string up in the .elf and does the formatting there. Each record looks like:
+ *
+ *   0x1E | length | address low | address high | arguments...
+ *
+ * length counts everything after itself. Arguments are stored the way printf() would see them: anything smaller than an int
+ * is promoted to int (2 bytes), float to double (4 bytes on AVR), long is 4 bytes, long long 8. A RAM string (for %s) is copied
+ * in, including the terminating null; a flash string (for %S) is sent as its address. All multibyte values are little endian.
+ * That way the decoder can walk the format string to know how many bytes each argument takes, just like vprintf() does.
+ * If the arguments don't fit in BINLOG_MAX_RECORD, the record is cut short and the decoder will say so.
+ *
+ * The format strings must be in the first 64k of flash. PROGMEM strings always are, since the linker puts them first.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#if !defined(BINLOG_MAX_RECORD)
+  #define BINLOG_MAX_RECORD 32
+#endif
+#define BINLOG_MARKER 0x1E  // ASCII Record Separator
+
+class BinaryLog {
+  public:
+    BinaryLog(Print &out) : _out(out) {}
+
+    template<typename... Args> size_t log(const __FlashStringHelper *format, Args... args) {
+      uint8_t buf[BINLOG_MAX_RECORD];
+      uint16_t address = (uint16_t)(uintptr_t) format;
+      buf[0] = BINLOG_MARKER;
+      buf[2] = (uint8_t) address;
+      buf[3] = (uint8_t) (address >> 8);
+      uint8_t pos = 4;
+      _put(buf, pos, args...);
+      buf[1] = pos - 2;
+      return _out.write(buf, pos);
+    }
+
+  private:
+    Print &_out;
+
+    static void _put(uint8_t *buf, uint8_t &pos) {(void) buf; (void) pos;}
+    template<typename T, typename... Rest> static void _put(uint8_t *buf, uint8_t &pos, T first, Rest... rest) {
+      _put1(buf, pos, first);
+      _put(buf, pos, rest...);
+    }
+    // These overloads do the default argument promotions for us: char, bool, etc become int, and float becomes double.
+    static void _put1(uint8_t *buf, uint8_t &pos,                int v) {_raw(buf, pos, &v, sizeof(v));}
+    static void _put1(uint8_t *buf, uint8_t &pos,       unsigned int v) {_raw(buf, pos, &v, sizeof(v));}
+    static void _put1(uint8_t *buf, uint8_t &pos,               long v) {_raw(buf, pos, &v, sizeof(v));}
+    static void _put1(uint8_t *buf, uint8_t &pos,      unsigned long v) {_raw(buf, pos, &v, sizeof(v));}
+    static void _put1(uint8_t *buf, uint8_t &pos,          long long v) {_raw(buf, pos, &v, sizeof(v));}
+    static void _put1(uint8_t *buf, uint8_t &pos, unsigned long long v) {_raw(buf, pos, &v, sizeof(v));}
+    static void _put1(uint8_t *buf, uint8_t &pos,             double v) {_raw(buf, pos, &v, sizeof(v));}
+    static void _put1(uint8_t *buf, uint8_t &pos,         const void *v) {uint16_t a = (uint16_t)(uintptr_t) v; _raw(buf, pos, &a, 2);} // %p
+    static void _put1(uint8_t *buf, uint8_t &pos, const __FlashStringHelper *v) {uint16_t a = (uint16_t)(uintptr_t) v; _raw(buf, pos, &a, 2);} // %S
+    static void _put1(uint8_t *buf, uint8_t &pos,         const char *v) { // %s - has to be copied, since the decoder can't see RAM.
+      if (v == NULL) {
+        v = "(null)";
+      }
+      do {
+        if (pos >= BINLOG_MAX_RECORD) {
+          return;
+        }
+        buf[pos++] = *v;
+      } while (*v++);
+    }
+    static void _raw(uint8_t *buf, uint8_t &pos, const void *v, uint8_t size) {
+      if (pos + size > BINLOG_MAX_RECORD) {
+        pos = BINLOG_MAX_RECORD;    // Don't send part of a value - the decoder will see the record is short.
+        return;
+      }
+      memcpy(buf + pos, v, size);
+      pos += size;
+    }
+};
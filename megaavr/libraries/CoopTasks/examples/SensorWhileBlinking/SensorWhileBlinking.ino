@@ -0,0 +1,46 @@
+/* SensorWhileBlinking - one task waits on Serial with readBytes(), one polls the ADC, and loop() blinks the LED with delay().
+ * None of them are written to avoid blocking, yet none of them hold up the others, because delay() and the timed Stream reads
+ * call yield(), and yield() switches to the next task.
+ *
+ * Send 4 characters in the serial monitor and they'll be echoed back. Every second, the reading on PIN_PD1 is printed.
+ */
+#include <CoopTasks.h>
+
+TASK_STACK(serialStack, 160);
+TASK_STACK(adcStack, 128);
+
+void serialTask() {
+  char buf[4];
+  // readBytes() waits up to the stream timeout (1 second by default) for each character. Other tasks run in the meantime.
+  if (Serial.readBytes(buf, 4) == 4) {
+    Serial.print("Got: ");
+    Serial.write(buf, 4);
+    Serial.println();
+  }
+}
+
+void adcTask() {
+  Serial.print("PD1: ");
+  Serial.println(analogRead(PIN_PD1));
+  delay(1000);
+}
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(LED_BUILTIN, OUTPUT);
+  Tasks.start(serialTask, serialStack);
+  Tasks.start(adcTask, adcStack);
+}
+
+void loop() {
+  digitalWriteFast(LED_BUILTIN, CHANGE);
+  delay(250);
+  static uint8_t n;
+  if (++n == 40) {                       // Every 10 seconds, see how close the stacks have come to overflowing.
+    n = 0;
+    Serial.print("Unused stack: ");
+    Serial.print(Tasks.stackFree(1));
+    Serial.print(", ");
+    Serial.println(Tasks.stackFree(2));
+  }
+}
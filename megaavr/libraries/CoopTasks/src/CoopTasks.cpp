@@ -0,0 +1,132 @@
+#include "CoopTasks.h"
+
+#define STACK_PAINT 0xA5
+
+CoopTaskList Tasks;
+
+typedef struct {
+  uint16_t    sp;           // Saved stack pointer, while the task isn't running.
+  voidFuncPtr func;
+  uint8_t    *stack;        // Bottom of the stack (for stackFree()), NULL for loop().
+  uint16_t    size;
+} coopTask_t;
+
+static coopTask_t _tasks[COOPTASKS_MAX];
+static uint8_t _task_count = 1;     // loop() is always there.
+static uint8_t _task_current = 0;
+
+/* Save the call-saved registers on the current stack, store the stack pointer through save_sp, switch to new_sp, and
+ * restore the registers that were saved there. The ret then returns into the yield() call of the other task. Everything
+ * else is either call-used, so the compiler doesn't expect it to survive a function call, or r1, which is always 0 here. */
+extern "C" void _task_switch(uint16_t *save_sp, uint16_t new_sp) __attribute__((naked, noinline, used));
+void _task_switch(__attribute__((unused)) uint16_t *save_sp, __attribute__((unused)) uint16_t new_sp) {
+  __asm__ __volatile__(
+    "push   r2"           "\n\t"
+    "push   r3"           "\n\t"
+    "push   r4"           "\n\t"
+    "push   r5"           "\n\t"
+    "push   r6"           "\n\t"
+    "push   r7"           "\n\t"
+    "push   r8"           "\n\t"
+    "push   r9"           "\n\t"
+    "push  r10"           "\n\t"
+    "push  r11"           "\n\t"
+    "push  r12"           "\n\t"
+    "push  r13"           "\n\t"
+    "push  r14"           "\n\t"
+    "push  r15"           "\n\t"
+    "push  r16"           "\n\t"
+    "push  r17"           "\n\t"
+    "push  r28"           "\n\t"
+    "push  r29"           "\n\t"
+    "movw  r30,       r24"   "\n\t" // save_sp
+    "in     r0, __SP_L__"    "\n\t"
+    "st     Z+,        r0"   "\n\t"
+    "in     r0, __SP_H__"    "\n\t"
+    "st      Z,        r0"   "\n\t"
+    "out  __SP_L__,   r22"   "\n\t" // Writing SPL holds off interrupts until SPH is written (or 4 instructions go by),
+    "out  __SP_H__,   r23"   "\n\t" // so an ISR can't run with half of the new stack pointer.
+    "pop   r29"           "\n\t"
+    "pop   r28"           "\n\t"
+    "pop   r17"           "\n\t"
+    "pop   r16"           "\n\t"
+    "pop   r15"           "\n\t"
+    "pop   r14"           "\n\t"
+    "pop   r13"           "\n\t"
+    "pop   r12"           "\n\t"
+    "pop   r11"           "\n\t"
+    "pop   r10"           "\n\t"
+    "pop    r9"           "\n\t"
+    "pop    r8"           "\n\t"
+    "pop    r7"           "\n\t"
+    "pop    r6"           "\n\t"
+    "pop    r5"           "\n\t"
+    "pop    r4"           "\n\t"
+    "pop    r3"           "\n\t"
+    "pop    r2"           "\n\t"
+    "ret"                 "\n\t"
+    ::);
+}
+
+// A new task's stack is set up so that the first switch to it "returns" here.
+static void __attribute__((noreturn, used)) _task_entry() {
+  for (;;) {
+    _tasks[_task_current].func();
+    yield();
+  }
+}
+
+// Overrides the empty weak yield() in the core. With only loop() running, it's the same as before.
+void yield() {
+  if (_task_count < 2) {
+    return;
+  }
+  uint8_t from = _task_current;
+  uint8_t to = from + 1;
+  if (to >= _task_count) {
+    to = 0;
+  }
+  _task_current = to;
+  _task_switch(&_tasks[from].sp, _tasks[to].sp);
+}
+
+int8_t CoopTaskList::start(voidFuncPtr task, uint8_t *stack, uint16_t size) {
+  if (_task_count >= COOPTASKS_MAX || size < COOPTASKS_MIN_STACK || task == NULL) {
+    return -1;
+  }
+  memset(stack, STACK_PAINT, size);
+  /* Build the frame that _task_switch() expects to find: the return address (high byte below low byte, as a call leaves it,
+   * and as a word address, which is what a function pointer holds), and below it 18 saved registers, which start out as 0. */
+  uint8_t *top = stack + size - 1;
+  uint16_t entry = (uint16_t) &_task_entry;
+  top[0]  = (uint8_t) entry;
+  top[-1] = (uint8_t)(entry >> 8);
+  memset(top - 19, 0, 18);
+  uint8_t n = _task_count;
+  _tasks[n].sp    = (uint16_t)(top - 20); // The stack pointer points at the next free byte, below what was last pushed.
+  _tasks[n].func  = task;
+  _tasks[n].stack = stack;
+  _tasks[n].size  = size;
+  _task_count = n + 1;                    // Only now can yield() switch to it.
+  return n;
+}
+
+uint8_t CoopTaskList::count() {
+  return _task_count;
+}
+
+uint8_t CoopTaskList::current() {
+  return _task_current;
+}
+
+uint16_t CoopTaskList::stackFree(uint8_t task) {
+  if (task >= _task_count || _tasks[task].stack == NULL) {
+    return 0;
+  }
+  uint8_t *p = _tasks[task].stack;
+  uint16_t n = 0;
+  while (n < _tasks[task].size && p[n] == STACK_PAINT) {
+    n++;
+  }
+  return n;
+}
@@ -0,0 +1,50 @@
+/* CoopTasks.h - cooperative multitasking for DxCore
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * Each task is a function that gets called over and over, like loop(), with its own stack. loop() is task 0, and runs on
+ * the normal stack. Tasks take turns: whenever the running task calls yield() - which delay() does while it waits, and so
+ * do Stream's timed reads (readBytes(), parseInt() and friends) - the next task picks up where it left off. Nothing ever
+ * switches tasks behind your back, so there's no need for locking between tasks, but a task that never calls yield() or
+ * delay() starves all the others.
+ *
+ * A task switch saves the call-saved registers on the old task's stack, swaps the stack pointer, and restores the new task's
+ * registers from its stack: 18 pushes, 18 pops, and a couple of dozen clocks of bookkeeping. Interrupts use the stack of
+ * whichever task was running, so every task stack needs room for the deepest ISR as well as the task itself.
+ */
+
+#ifndef COOPTASKS_H
+#define COOPTASKS_H
+#include <Arduino.h>
+
+#if defined(__AVR_3_BYTE_PC__)
+  #error "CoopTasks assumes a 2-byte return address, which all Dx and Ex-series parts use."
+#endif
+
+#define COOPTASKS_MAX        8      // Including loop().
+#define COOPTASKS_MIN_STACK  64     // Enough for the saved context, a few calls and a small ISR. Use more.
+
+// Stacks must be global or static. This declares one of the given size.
+#define TASK_STACK(name, size) static uint8_t name[size]
+
+class CoopTaskList {
+  public:
+    CoopTaskList() {}
+    /* Add a task, which will first be run the next time the current task yields. Returns the task number, or -1 if there
+     * are already COOPTASKS_MAX tasks, or the stack is smaller than COOPTASKS_MIN_STACK. The stack is filled with a marker
+     * value so that stackFree() can tell how much has been used. */
+    int8_t start(voidFuncPtr task, uint8_t *stack, uint16_t size);
+    template <uint16_t size>
+    int8_t start(voidFuncPtr task, uint8_t (&stack)[size]) {
+      return start(task, stack, size);
+    }
+    uint8_t count();        // Number of tasks, including loop().
+    uint8_t current();      // Number of the task that is running; loop() is 0.
+    /* How many bytes at the bottom of a task's stack have never been used. If this gets near 0, it's time for a bigger stack;
+     * if it reaches 0, the stack has already overflowed into whatever is below it. Always 0 for loop(). */
+    uint16_t stackFree(uint8_t task);
+};
+
+extern CoopTaskList Tasks;
+
+#endif
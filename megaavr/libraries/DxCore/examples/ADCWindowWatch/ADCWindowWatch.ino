@@ -0,0 +1,40 @@
+/* ADCWindowWatch - keep an eye on the voltage on PIN_PD1, and turn the LED on while it's out of range, while the chip sleeps.
+ *
+ * analogWindowStart() sets the ADC running on its own, and has the window comparator check each reading, so the CPU only
+ * wakes up when the reading leaves the range between LOW_LIMIT and HIGH_LIMIT, or comes back into it. The rest of the time,
+ * it's in standby sleep. The callback is run from the ADC interrupt, so it just records what happened; loop() prints it.
+ */
+#include <avr/sleep.h>
+
+#define LOW_LIMIT  1000
+#define HIGH_LIMIT 3000
+
+volatile bool changed = false;
+volatile int16_t lastValue;
+
+void windowChange(bool inside, int16_t value) {
+  digitalWriteFast(LED_BUILTIN, inside ? LOW : HIGH);
+  lastValue = value;
+  changed = true;
+}
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(LED_BUILTIN, OUTPUT);
+  analogReadResolution(12);
+  if (!analogWindowStart(PIN_PD1, LOW_LIMIT, HIGH_LIMIT, windowChange, ADC_WINDOW_FREERUN)) {
+    Serial.println("Couldn't start the window watch");
+  }
+  digitalWriteFast(LED_BUILTIN, analogWindowInside() ? LOW : HIGH); // The callback only comes on a crossing, so start it right.
+  set_sleep_mode(SLEEP_MODE_STANDBY);
+}
+
+void loop() {
+  if (changed) {
+    changed = false;
+    Serial.print(analogWindowInside() ? "Back in range: " : "Out of range: ");
+    Serial.println(lastValue);
+    Serial.flush();                   // Serial doesn't run in standby, so finish printing before going to sleep.
+  }
+  sleep_mode();                       // Sleep until the window comparator wakes us.
+}
@@ -0,0 +1,95 @@
+/* RS485Transact - a minimal Modbus RTU master using Serial.transact(), polling a range of slave addresses without ever blocking.
+ *
+ * This requires the core to be built with -DSERIAL_FRAMED_RX (for example, in platform.local.txt:
+ * compiler.cpp.extra_flags=-DSERIAL_FRAMED_RX ).
+ *
+ * Serial1 is the RS485 port, with the line driver's DE (and /RE, if it is tied to DE) connected to XDIR - the pin after XCK, so PC3
+ * with the default pins. The response to each request is ended by 3.5 character times of silence, which is timed by TCB1 (so don't
+ * use millis on TCB1 with this example). Each poll reads 4 holding registers starting at 0 from one slave; the callback runs from the
+ * ISR when the response arrives (or the timeout runs out) and just records that, and loop() starts the next request before it prints
+ * the result of the last one, so the bus is never idle waiting on the serial monitor.
+ */
+
+#if !defined(SERIAL_FRAMED_RX)
+  #error "This example requires the core to be compiled with SERIAL_FRAMED_RX defined"
+#endif
+
+#define MODBUS_BAUD     19200
+#define FIRST_SLAVE     1
+#define LAST_SLAVE      16
+#define TIMEOUT_MS      50
+
+SERIAL_FRAME_TIMEOUT_ISR(TCB1, Serial1)
+
+uint8_t request[8];
+uint8_t response[16];
+volatile uint8_t slave = FIRST_SLAVE;
+volatile uint8_t doneSlave;
+volatile uint16_t doneLength;
+volatile bool resultReady = false;
+
+uint16_t modbusCRC(const uint8_t *data, uint8_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+    }
+  }
+  return crc;
+}
+
+void buildRequest(uint8_t address) {
+  request[0] = address;
+  request[1] = 0x03;      // Read holding registers
+  request[2] = 0x00;      // starting at 0
+  request[3] = 0x00;
+  request[4] = 0x00;      // 4 of them
+  request[5] = 0x04;
+  uint16_t crc = modbusCRC(request, 6);
+  request[6] = crc & 0xFF;
+  request[7] = crc >> 8;
+}
+
+// Called from the ISR, so we just record the result; the response buffer is copied by loop() before the next request is started.
+void transactionDone(uint16_t length) {
+  doneSlave  = slave;
+  doneLength = length;
+  resultReady = true;
+}
+
+void startNext() {
+  buildRequest(slave);
+  Serial1.transact(request, sizeof(request), response, sizeof(response), TIMEOUT_MS, transactionDone);
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial1.begin(MODBUS_BAUD, SERIAL_8N1 | SERIAL_RS485);
+  Serial1.framedRx(SERIAL_FRAME_NO_DELIMITER, sizeof(response));
+  // Modbus calls for 3.5 character times of silence, and a character is 11 bits. Above 19200 baud, it's fixed at 1750 us.
+  Serial1.framedRxTimeout(TCB1, MODBUS_BAUD > 19200 ? 1750 : (uint16_t)(35UL * 11 * 100000UL / MODBUS_BAUD));
+  startNext();
+}
+
+void loop() {
+  if (resultReady) {
+    uint8_t copy[sizeof(response)];
+    uint16_t len = doneLength;
+    uint8_t addr = doneSlave;
+    memcpy(copy, response, len);
+    resultReady = false;
+    slave = (slave >= LAST_SLAVE) ? FIRST_SLAVE : slave + 1;
+    startNext();              // the next request goes out while we print this one.
+    Serial.print("Slave ");
+    Serial.print(addr);
+    if (len == 0) {
+      Serial.println(": no response");
+    } else if (len < 5 || copy[2] != len - 5 || modbusCRC(copy, len - 2) != (copy[len - 2] | (copy[len - 1] << 8))) {
+      Serial.println(": bad response");
+    } else {
+      Serial.print(": ");
+      Serial.printHexln(copy + 3, copy[2], ' ');
+    }
+  }
+}
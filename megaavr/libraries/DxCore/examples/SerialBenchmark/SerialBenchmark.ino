@@ -0,0 +1,281 @@
+/* SerialBenchmark - measures the throughput and CPU cost of every serial port on the part, at a range of baud rates.
+ *
+ * Every port is tested in turn, using loopback mode for the receive test, so nothing needs to be connected, but the TX pin of each
+ * port is driven during its test (including the one for Serial, so the serial monitor will see a burst of garbage - ignore it).
+ * The results for each port are printed on Serial at 115200 baud after that port is done, as comma separated lines starting with
+ * UARTBENCH, so they can be picked out of the output by a script and compared between versions of the core:
+ *
+ * UARTBENCH,port,F_CPU,baud,test,bytes,microseconds,bytes per second,CPU clocks per byte x 10,worst-case stall,errors
+ *
+ * Tests:
+ *   write - BLOCK_SIZE bytes with write(), only writing as many as availableForWrite() says will fit, so that we never block in
+ *           write() and count time that was just spent waiting as lost.
+ *   print - The same amount of data, 32 characters per print().
+ *   rx    - BLOCK_SIZE bytes sent in loopback mode with writeBlock() and read back with read() as fast as possible. Errors is the
+ *           number of bytes that were lost or corrupted - if it is not 0, the port can't sustain reception at that baud rate.
+ *
+ * CPU clocks per byte is found by counting how many times the sketch gets around the test loop, and comparing that with how many
+ * times it gets around the same loop in the same amount of time with the port idle. The difference is the time that went to the
+ * ISRs (and for write and print, the time spent in those functions) - so this is the number to watch when changing the ISRs.
+ *
+ * Worst-case stall is the longest the test loop was held up in one go, in CPU clocks, less the longest it was held up with the
+ * port idle (by millis and anything else running), timed with a type B timer counting the system clock. In the rx test, the loop
+ * only calls read(), so this is the longest time the serial interrupts kept the CPU - the worst-case latency they add to every
+ * other interrupt, and most of the latency of the RX interrupt itself. In the write and print tests it includes the time spent
+ * in write() and print().
+ *
+ * The baud rates are those in bauds[] up to F_CPU / 8 (each tested once). The system clock can't be changed while the sketch is
+ * running, so to cover other clock speeds, build and run it again at each one - every line carries F_CPU for that reason.
+ */
+
+#define BLOCK_SIZE  512
+
+const uint32_t bauds[] = {115200, 250000, 500000, 1000000, 2000000, F_CPU / 8};
+#define BAUD_COUNT (sizeof(bauds) / sizeof(bauds[0]))
+
+// The timer used to time the stalls, which must not be the millis timer. It's only read, never interrupts.
+#if defined(MILLIS_USE_TIMERB0)
+  #define BENCH_TIMER TCB1
+#else
+  #define BENCH_TIMER TCB0
+#endif
+
+HardwareSerial * const ports[] = {
+  #if defined(HAVE_HWSERIAL0)
+  &Serial0,
+  #endif
+  #if defined(HAVE_HWSERIAL1)
+  &Serial1,
+  #endif
+  #if defined(HAVE_HWSERIAL2)
+  &Serial2,
+  #endif
+  #if defined(HAVE_HWSERIAL3)
+  &Serial3,
+  #endif
+  #if defined(HAVE_HWSERIAL4)
+  &Serial4,
+  #endif
+  #if defined(HAVE_HWSERIAL5)
+  &Serial5,
+  #endif
+};
+const uint8_t portNumbers[] = {
+  #if defined(HAVE_HWSERIAL0)
+  0,
+  #endif
+  #if defined(HAVE_HWSERIAL1)
+  1,
+  #endif
+  #if defined(HAVE_HWSERIAL2)
+  2,
+  #endif
+  #if defined(HAVE_HWSERIAL3)
+  3,
+  #endif
+  #if defined(HAVE_HWSERIAL4)
+  4,
+  #endif
+  #if defined(HAVE_HWSERIAL5)
+  5,
+  #endif
+};
+
+typedef struct {
+  uint32_t baud;
+  const char * test;
+  uint32_t duration;     // microseconds
+  uint32_t lostClocks;   // CPU clocks that the sketch didn't get
+  uint16_t stall;        // worst-case clocks the loop was held up, more than when idle
+  uint16_t errors;
+} result_t;
+
+result_t results[BAUD_COUNT * 3];
+uint8_t resultCount;
+
+uint8_t testdata[BLOCK_SIZE];
+const char text[] = "The quick brown fox jumps over\r\n"; // 32 characters
+
+uint16_t lastCount, maxGap;
+
+void gapStart() {
+  maxGap = 0;
+  lastCount = BENCH_TIMER.CNT;
+}
+
+// Called once each time around every test loop, to find the longest time between two passes.
+void gapCheck() {
+  uint16_t now = BENCH_TIMER.CNT;
+  uint16_t gap = now - lastCount;
+  lastCount = now;
+  if (gap > maxGap) {
+    maxGap = gap;
+  }
+}
+
+// The reference loop. If port is not NULL, it calls read() on it (which must have been ended, so it just returns -1) each time around, like the rx test.
+uint32_t idleLoops(uint32_t duration, HardwareSerial * port) {
+  uint32_t count = 0;
+  uint32_t start = micros();
+  gapStart();
+  while (micros() - start < duration) {
+    if (port) {
+      (void) port->read();
+    }
+    count++;
+    gapCheck();
+  }
+  return count;
+}
+
+void record(uint32_t baud, const char * test, uint32_t duration, uint32_t busy, uint16_t errors, HardwareSerial * port) {
+  uint16_t busyGap = maxGap;
+  uint32_t idle = idleLoops(duration, port);
+  if (busy > idle) {
+    busy = idle; // can only happen from noise if serial costs next to nothing.
+  }
+  result_t * r = &results[resultCount++];
+  r->baud       = baud;
+  r->test       = test;
+  r->duration   = duration;
+  r->lostClocks = (uint32_t)((uint64_t)(F_CPU / 1000000UL) * duration * (idle - busy) / idle);
+  r->stall      = (busyGap > maxGap) ? busyGap - maxGap : 0;
+  r->errors     = errors;
+}
+
+void testWrite(HardwareSerial &port, uint32_t baud) {
+  uint32_t count = 0;
+  uint16_t sent = 0;
+  port.begin(baud);
+  uint32_t start = micros();
+  gapStart();
+  while (sent < BLOCK_SIZE) {
+    int16_t room = port.availableForWrite();
+    while (room-- > 0 && sent < BLOCK_SIZE) {
+      port.write(testdata[sent++]);
+    }
+    count++;
+    (void) micros();
+    gapCheck();
+  }
+  port.flush();
+  uint32_t duration = micros() - start;
+  port.end();
+  record(baud, "write", duration, count, 0, NULL);
+}
+
+void testPrint(HardwareSerial &port, uint32_t baud) {
+  uint32_t count = 0;
+  uint16_t sent = 0;
+  port.begin(baud);
+  uint32_t start = micros();
+  gapStart();
+  while (sent < BLOCK_SIZE) {
+    if (port.availableForWrite() >= 32) {
+      port.print(text);
+      sent += 32;
+    }
+    count++;
+    (void) micros();
+    gapCheck();
+  }
+  port.flush();
+  uint32_t duration = micros() - start;
+  port.end();
+  record(baud, "print", duration, count, 0, NULL);
+}
+
+void testRx(HardwareSerial &port, uint32_t baud) {
+  uint32_t count = 0;
+  uint16_t received = 0, errors = 0;
+  // Twice as long as it should take, plus a millisecond.
+  uint32_t timeout = (BLOCK_SIZE * 10UL * 1000UL) / (baud / 1000) * 2 + 1000;
+  port.begin(baud, SERIAL_8N1 | SERIAL_LOOPBACK);
+  (void) port.getStatus();   // clear any errors
+  uint32_t start = micros();
+  port.writeBlock(testdata, BLOCK_SIZE);
+  gapStart();
+  while (received < BLOCK_SIZE && micros() - start < timeout) {
+    int16_t c = port.read();
+    if (c >= 0) {
+      if ((uint8_t) c != testdata[received]) {
+        errors++;
+      }
+      received++;
+    }
+    count++;
+    gapCheck();
+  }
+  uint32_t duration = micros() - start;
+  port.end();
+  record(baud, "rx", duration, count, errors + (BLOCK_SIZE - received), &port);
+}
+
+void report(uint8_t n) {
+  for (uint8_t i = 0; i < resultCount; i++) {
+    result_t * r = &results[i];
+    uint32_t tenths = r->lostClocks * 10 / BLOCK_SIZE;
+    Serial.print(F("UARTBENCH,Serial"));
+    Serial.print(n);
+    Serial.print(',');
+    Serial.print(F_CPU);
+    Serial.print(',');
+    Serial.print(r->baud);
+    Serial.print(',');
+    Serial.print(r->test);
+    Serial.print(',');
+    Serial.print(BLOCK_SIZE);
+    Serial.print(',');
+    Serial.print(r->duration);
+    Serial.print(',');
+    Serial.print((BLOCK_SIZE * 1000000UL) / r->duration);
+    Serial.print(',');
+    Serial.print(tenths);
+    Serial.print(',');
+    Serial.print(r->stall);
+    Serial.print(',');
+    Serial.println(r->errors);
+  }
+}
+
+void setup() {
+  for (uint16_t i = 0; i < BLOCK_SIZE; i++) {
+    testdata[i] = (uint8_t) i;
+  }
+  BENCH_TIMER.CCMP  = 0xFFFF;              // count the system clock round and round
+  BENCH_TIMER.CTRLB = TCB_CNTMODE_INT_gc;
+  BENCH_TIMER.CTRLA = TCB_CLKSEL_DIV1_gc | TCB_ENABLE_bm;
+}
+
+// True if baud is too fast for this clock speed, or comes up more than once in bauds[] (F_CPU / 8 may be one of the others).
+bool skipBaud(uint8_t b) {
+  if (bauds[b] > F_CPU / 8) {
+    return true;
+  }
+  for (uint8_t i = 0; i < b; i++) {
+    if (bauds[i] == bauds[b]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void loop() {
+  for (uint8_t p = 0; p < sizeof(portNumbers); p++) {
+    resultCount = 0;
+    for (uint8_t b = 0; b < BAUD_COUNT; b++) {
+      if (skipBaud(b)) {
+        continue;
+      }
+      testWrite(*ports[p], bauds[b]);
+      testPrint(*ports[p], bauds[b]);
+      testRx(*ports[p], bauds[b]);
+    }
+    Serial.begin(115200);
+    Serial.println();
+    report(portNumbers[p]);
+    Serial.flush();
+    Serial.end();
+  }
+  delay(10000);
+}
@@ -0,0 +1,98 @@
+/* SerialBlockWrite - compares Serial.write() through the ring buffer with Serial.writeBlock()
+ *
+ * Nothing needs to be connected to the TX pin during the test; the results are printed at 115200 baud afterwards.
+ *
+ * For each method, we send BLOCK_SIZE bytes at TEST_BAUD, and while that is going on, the main loop just counts how
+ * many times it gets around a trivial loop. Then we do the same thing for the same length of time with no serial
+ * activity. Whatever fraction of the loop passes we lost went to serial - the ISR, plus for write(), the time spent
+ * in write() itself. Multiply that by the number of clocks that elapsed and divide by the number of bytes, and you get
+ * the CPU cost per byte. The ring buffer test only writes as much as availableForWrite() says will fit, so that we
+ * never block in write() and count time that is really just waiting as "lost".
+ *
+ * Each loop calls micros() once per pass, so that the idle loop, which needs it to know when to stop, doesn't run
+ * faster than the others and skew the results.
+ */
+
+#define TEST_BAUD   1000000
+#define BLOCK_SIZE  1024
+
+uint8_t testdata[BLOCK_SIZE];
+
+uint32_t idleLoops(uint32_t duration) {
+  uint32_t count = 0;
+  uint32_t start = micros();
+  while (micros() - start < duration) {
+    count++;
+  }
+  return count;
+}
+
+uint32_t ringLoops(uint32_t *duration) {
+  uint32_t count = 0;
+  uint16_t sent = 0;
+  uint32_t start = micros();
+  while (sent < BLOCK_SIZE) {
+    int16_t room = Serial.availableForWrite();
+    while (room-- > 0 && sent < BLOCK_SIZE) {
+      Serial.write(testdata[sent++]);
+    }
+    count++;
+    (void) micros();
+  }
+  Serial.flush();
+  *duration = micros() - start;
+  return count;
+}
+
+uint32_t blockLoops(uint32_t *duration) {
+  uint32_t count = 0;
+  uint32_t start = micros();
+  Serial.writeBlock(testdata, BLOCK_SIZE);
+  while (Serial.writeBlockBusy()) {
+    count++;
+    (void) micros();
+  }
+  Serial.flush();
+  *duration = micros() - start;
+  return count;
+}
+
+void report(const char *name, uint32_t busy, uint32_t idle, uint32_t duration) {
+  // clocks per byte = (1 - busy / idle) * (F_CPU * duration / 1000000) / BLOCK_SIZE
+  // duration is in us, so F_CPU / 1000000 * duration is the number of clocks the test took.
+  uint32_t clocks = (F_CPU / 1000000UL) * duration;
+  if (busy > idle) {
+    busy = idle; // can only happen from noise if serial costs next to nothing.
+  }
+  uint32_t lost = (uint32_t)((uint64_t)clocks * (idle - busy) / idle);
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(((uint32_t)BLOCK_SIZE * 1000000UL) / duration);
+  Serial.print(" bytes/s, ");
+  Serial.print(lost / BLOCK_SIZE);
+  Serial.print('.');
+  Serial.print(((lost % BLOCK_SIZE) * 10) / BLOCK_SIZE);
+  Serial.println(" clocks of CPU time per byte");
+}
+
+void setup() {
+  for (uint16_t i = 0; i < BLOCK_SIZE; i++) {
+    testdata[i] = (uint8_t) i;
+  }
+}
+
+void loop() {
+  uint32_t ringTime, blockTime;
+  Serial.begin(TEST_BAUD);
+  uint32_t ring  = ringLoops(&ringTime);
+  uint32_t block = blockLoops(&blockTime);
+  uint32_t idleRing  = idleLoops(ringTime);
+  uint32_t idleBlock = idleLoops(blockTime);
+  Serial.end();
+  Serial.begin(115200);
+  Serial.println();
+  report("write()     ", ring, idleRing, ringTime);
+  report("writeBlock()", block, idleBlock, blockTime);
+  Serial.flush();
+  delay(5000);
+}
@@ -0,0 +1,59 @@
+/* SerialFramedRx - receive COBS encoded packets on Serial1 using framedRx(), and report them on Serial.
+ *
+ * This requires the core to be built with -DSERIAL_FRAMED_RX (for example, in platform.local.txt:
+ * compiler.cpp.extra_flags=-DSERIAL_FRAMED_RX ), because the frame detection lives in the RXC ISR.
+ *
+ * COBS (Consistent Overhead Byte Stuffing) encodes a packet so that it contains no zeros, and then a zero is sent to mark the end.
+ * The ISR finds the zeros, so by the time we see a frame it is complete, and we decode it in place, since the decoded data is never
+ * longer than the encoded data. A frame is also ended if the line is idle for 2 ms, so a sender that dies mid-packet doesn't leave
+ * a half-packet that gets glued to the front of the next one - this uses TCB1, so don't use this example with millis on TCB1.
+ */
+
+#if !defined(SERIAL_FRAMED_RX)
+  #error "This example requires the core to be compiled with SERIAL_FRAMED_RX defined"
+#endif
+
+SERIAL_FRAME_TIMEOUT_ISR(TCB1, Serial1)
+
+// Decode a COBS frame (without the trailing zero) in place. Returns the decoded length, or 0 if the frame is not valid COBS.
+uint16_t cobsDecode(uint8_t *data, uint16_t len) {
+  uint16_t in = 0, out = 0;
+  while (in < len) {
+    uint8_t code = data[in++];
+    if (code == 0 || in + code - 1 > len) {
+      return 0;
+    }
+    for (uint8_t i = 1; i < code; i++) {
+      data[out++] = data[in++];
+    }
+    if (code != 0xFF && in < len) {
+      data[out++] = 0;
+    }
+  }
+  return out;
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial1.begin(115200);
+  Serial1.framedRx(0x00, 64);       // COBS delimiter is 0, and our packets are never more than 64 bytes.
+  Serial1.framedRxTimeout(TCB1, 2000);
+}
+
+void loop() {
+  uint8_t *frame;
+  uint16_t len = Serial1.getFrame(&frame);
+  if (len) {
+    len = cobsDecode(frame, len);
+    if (len) {
+      Serial.print("Packet: ");
+      Serial.printHexln(frame, len, ' ');
+    } else {
+      Serial.println("Bad COBS frame");
+    }
+    Serial1.releaseFrame();
+  }
+  if (Serial1.getStatus() & SERIAL_OVERFLOW_RING) {
+    Serial.println("Frame dropped");
+  }
+}
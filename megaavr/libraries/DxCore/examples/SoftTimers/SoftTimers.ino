@@ -0,0 +1,42 @@
+/* SoftTimers - blink the LED, print the time, and time out a button press, without a single millis() comparison in loop().
+ *
+ * timerEvery() and timerOnce() ask the core to call a function later. The calls are made after loop() returns (and while
+ * waiting in delay()), so loop() must not get stuck - here it's empty. The softTimer_t structs must stay put while the timers
+ * are pending, so they're global.
+ *
+ * Press a button on PIN_PA7 (to ground) to turn on PIN_PA6 for 2 seconds; each press restarts the 2 seconds.
+ */
+
+softTimer_t blinkTimer;
+softTimer_t printTimer;
+softTimer_t offTimer;
+
+void blink() {
+  digitalWriteFast(LED_BUILTIN, CHANGE);
+}
+
+void printTime() {
+  Serial.print("millis: ");
+  Serial.print(millis());
+  Serial.println(timerPending(&offTimer) ? " - output on" : "");
+}
+
+void outputOff() {
+  digitalWriteFast(PIN_PA6, LOW);
+}
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(LED_BUILTIN, OUTPUT);
+  pinMode(PIN_PA6, OUTPUT);
+  pinMode(PIN_PA7, INPUT_PULLUP);
+  timerEvery(&blinkTimer, 250, blink);
+  timerEvery(&printTimer, 1000, printTime);
+}
+
+void loop() {
+  if (!digitalReadFast(PIN_PA7)) {
+    digitalWriteFast(PIN_PA6, HIGH);
+    timerOnce(&offTimer, 2000, outputOff); // restarts it if it was already running.
+  }
+}
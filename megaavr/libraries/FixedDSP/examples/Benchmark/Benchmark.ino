@@ -0,0 +1,93 @@
+/* Benchmark - how many clock cycles each filter takes per sample, timed with a TCB counting the system clock - TCB0, or
+ * TCB1 if TCB0 is the millis timer. The same numbers come out under a simulator such as simavr, as long as it simulates
+ * that TCB.
+ *
+ * Divide F_CPU by the cycles per sample, and leave plenty of room for everything else, to see what sample rate a filter
+ * can keep up with.
+ */
+#include <FixedDSP.h>
+
+#define BLOCK 32
+
+// The timer used for timing, which must not be the millis timer.
+#if defined(MILLIS_USE_TIMERB0)
+  #define BENCH_TIMER TCB1
+#else
+  #define BENCH_TIMER TCB0
+#endif
+
+int16_t input[BLOCK];
+int16_t output[BLOCK];
+int32_t cicOutput[BLOCK];
+
+// Low pass, cutoff at a tenth of the sample rate: 15 taps of Hamming windowed sinc, and a 0 to make it 16.
+const int16_t firTaps[16] = {
+  Q15(-0.0036), Q15(-0.0041), Q15( 0.0000), Q15( 0.0213), Q15( 0.0673), Q15( 0.1299), Q15( 0.1854), Q15( 0.2076),
+  Q15( 0.1854), Q15( 0.1299), Q15( 0.0673), Q15( 0.0213), Q15( 0.0000), Q15(-0.0041), Q15(-0.0036), Q15( 0.0000)
+};
+const int8_t firTapsQ7[16] = {
+  Q7(-0.0036), Q7(-0.0041), Q7( 0.0000), Q7( 0.0213), Q7( 0.0673), Q7( 0.1299), Q7( 0.1854), Q7( 0.2076),
+  Q7( 0.1854), Q7( 0.1299), Q7( 0.0673), Q7( 0.0213), Q7( 0.0000), Q7(-0.0041), Q7(-0.0036), Q7( 0.0000)
+};
+// 2nd order Butterworth low pass at a tenth of the sample rate (remember: a1 and a2 have the sign flipped).
+const BiquadCoeffs lowpass[1] = {{Q14(0.0675), Q14(0.1349), Q14(0.0675), Q14(1.1430), Q14(-0.4128)}};
+
+int16_t       firState[16], firQ7State[16], maBuffer[16], medianBuffer[2 * 7];
+BiquadState   biquadState[1];
+FIRFilter     fir(firTaps, firState, 16);
+FIRFilterQ7   firQ7(firTapsQ7, firQ7State, 16);
+BiquadFilter  biquad(lowpass, biquadState, 1);
+CICDecimator  cic(3, 8);
+EMAFilter     ema(4);
+MovingAverage average(maBuffer, 16);
+MedianFilter  median(medianBuffer, 7);
+
+void startTimer() {
+  BENCH_TIMER.CTRLA = 0;
+  BENCH_TIMER.CTRLB = TCB_CNTMODE_INT_gc;
+  BENCH_TIMER.CCMP  = 0xFFFF;
+  BENCH_TIMER.CNT   = 0;
+  BENCH_TIMER.CTRLA = TCB_CLKSEL_DIV1_gc | TCB_ENABLE_bm;
+}
+
+void report(const char *name, uint16_t ticks, uint8_t samples) {
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(ticks / samples);
+  Serial.println(" cycles/sample");
+}
+
+// Interrupts are off while timing, so the millis interrupt isn't counted. A TCB only counts to 65535, so keep each test under that.
+#define TIME(name, samples, code) do { cli(); startTimer(); code; uint16_t t = BENCH_TIMER.CNT; sei(); report(name, t, samples); } while (0)
+
+void setup() {
+  Serial.begin(115200);
+  for (uint8_t i = 0; i < BLOCK; i++) {
+    input[i] = random(-2048, 2048);
+  }
+  TIME("FIR, 16 taps, Q15", BLOCK, fir.process(input, output, BLOCK));
+  TIME("FIR, 16 taps, Q7", BLOCK, firQ7.process(input, output, BLOCK));
+  TIME("Biquad, 1 section", BLOCK, biquad.process(input, output, BLOCK));
+  TIME("CIC, 3 stages, /8", BLOCK, cic.process(input, cicOutput, BLOCK));
+  TIME("EMA", BLOCK, ema.process(input, output, BLOCK));
+  TIME("Moving average, 16", BLOCK, average.process(input, output, BLOCK));
+  TIME("Median of 7", BLOCK, median.process(input, output, BLOCK));
+  float floatTaps[16];
+  for (uint8_t j = 0; j < 16; j++) {
+    floatTaps[j] = firTaps[j] / 32768.0f;
+  }
+  volatile float f = 0;
+  TIME("For comparison: float FIR, 16 taps", 8, {
+    for (uint8_t i = 0; i < 8; i++) {
+      float acc = 0;
+      for (uint8_t j = 0; j < 16; j++) {
+        acc += input[(i + j) & (BLOCK - 1)] * floatTaps[j];
+      }
+      f = acc;
+    }
+  });
+  (void) f;
+}
+
+void loop() {
+}
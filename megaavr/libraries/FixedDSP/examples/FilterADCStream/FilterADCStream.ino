@@ -0,0 +1,37 @@
+/* FilterADCStream - sample PD1 at 10 ksps with ADCStream, and run each block through a low pass biquad as it arrives, then
+ * decimate by 10 and print, for a clean 1 ksps signal. At 24 MHz, the biquad takes a small fraction of the time between
+ * blocks; a float filter would not keep up.
+ */
+#include <ADCStream.h>
+#include <FixedDSP.h>
+
+#define BLOCK 100
+
+int16_t bufA[BLOCK], bufB[BLOCK];
+const uint8_t pins[] = {PIN_PD1};
+
+// 4th order Butterworth low pass at 400 Hz for 10 ksps, as two sections, each with a gain of 1 at DC so that neither can
+// overflow. a1 and a2 have the sign flipped.
+const BiquadCoeffs lowpass[2] = {
+  {Q14(0.012774), Q14(0.025547), Q14(0.012774), Q14(1.575242), Q14(-0.626336)},
+  {Q14(0.014343), Q14(0.028687), Q14(0.014343), Q14(1.768828), Q14(-0.826201)}
+};
+BiquadState  state[2];
+BiquadFilter filter(lowpass, state, 2);
+
+void setup() {
+  Serial.begin(115200);
+  ADCStream.useTimer(TCB1);
+  ADCStream.begin(pins, 1, 10000, bufA, bufB, BLOCK);
+}
+
+void loop() {
+  int16_t *block = ADCStream.available();
+  if (block) {
+    filter.process(block, block, BLOCK);    // in place
+    for (uint8_t i = 0; i < BLOCK; i += 10) {
+      Serial.println(block[i]);
+    }
+    ADCStream.release();
+  }
+}
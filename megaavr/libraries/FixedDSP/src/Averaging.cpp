@@ -0,0 +1,112 @@
+#include "FixedDSP.h"
+
+/*########## Exponential ##########*/
+
+int16_t EMAFilter::process(int16_t sample) {
+  int32_t state = _state;
+  state += (((int32_t) sample * 32768) - state) >> _shift;
+  _state = state;
+  return (state + 0x4000) >> 15;
+}
+
+void EMAFilter::process(const int16_t *in, int16_t *out, uint16_t count) {
+  while (count--) {
+    *out++ = process(*in++);
+  }
+}
+
+/*########## Moving average ##########*/
+
+MovingAverage::MovingAverage(int16_t *buffer, uint16_t length) : _buffer(buffer), _length(length ? length : 1) {
+  _shift = 0xFF;
+  for (uint8_t i = 0; i < 16; i++) {
+    if (_length == (1U << i)) {
+      _shift = i;
+      break;
+    }
+  }
+  reset();
+}
+
+int16_t MovingAverage::process(int16_t sample) {
+  uint16_t pos = _pos;
+  int32_t sum = _sum - _buffer[pos] + sample;
+  _buffer[pos] = sample;
+  if (++pos == _length) {
+    pos = 0;
+  }
+  _pos = pos;
+  _sum = sum;
+  if (_shift != 0xFF) {
+    return sum >> _shift;
+  }
+  return sum / _length;
+}
+
+void MovingAverage::process(const int16_t *in, int16_t *out, uint16_t count) {
+  while (count--) {
+    *out++ = process(*in++);
+  }
+}
+
+void MovingAverage::reset() {
+  memset(_buffer, 0, _length * sizeof(int16_t));
+  _pos = 0;
+  _sum = 0;
+}
+
+/*########## Median ##########*/
+
+/* The first _length entries of _buffer are the history, in the order received (a circular buffer), and the second _length
+ * are the same samples, sorted. Each new sample replaces the oldest: we find the oldest in the sorted half, and slide the
+ * samples between it and where the new one belongs over by one. The median is then the middle of the sorted half. */
+
+MedianFilter::MedianFilter(int16_t *buffer, uint8_t length) : _buffer(buffer) {
+  if (length > MEDIAN_MAX_LENGTH) {
+    length = MEDIAN_MAX_LENGTH;
+  } else if (length == 0) {
+    length = 1;
+  } else if (!(length & 1)) {
+    length--;                   // only odd lengths have a middle.
+  }
+  _length = length;
+  reset();
+}
+
+int16_t MedianFilter::process(int16_t sample) {
+  uint8_t  len    = _length;
+  int16_t *sorted = _buffer + len;
+  int16_t  oldest = _buffer[_pos];
+  _buffer[_pos] = sample;
+  if (++_pos == len) {
+    _pos = 0;
+  }
+  uint8_t i = 0;
+  while (sorted[i] != oldest) {
+    i++;
+  }
+  if (sample > oldest) {        // the new one goes higher up: slide the ones in between down
+    while (i < len - 1 && sorted[i + 1] < sample) {
+      sorted[i] = sorted[i + 1];
+      i++;
+    }
+  } else {                      // or lower down: slide them up
+    while (i > 0 && sorted[i - 1] > sample) {
+      sorted[i] = sorted[i - 1];
+      i--;
+    }
+  }
+  sorted[i] = sample;
+  return sorted[len >> 1];
+}
+
+void MedianFilter::process(const int16_t *in, int16_t *out, uint16_t count) {
+  while (count--) {
+    *out++ = process(*in++);
+  }
+}
+
+void MedianFilter::reset() {
+  memset(_buffer, 0, 2 * _length * sizeof(int16_t));
+  _pos = 0;
+}
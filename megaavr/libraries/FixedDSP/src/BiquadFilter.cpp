@@ -0,0 +1,35 @@
+#include "FixedDSP.h"
+#include "dsp_asm.h"
+
+int16_t BiquadFilter::process(int16_t sample) {
+  const BiquadCoeffs *c = _coeffs;
+  BiquadState        *s = _state;
+  uint8_t n = _sections;
+  while (n--) {
+    int32_t acc = 0;
+    acc = _dsp_mac16(acc, sample, c->b0);
+    acc = _dsp_mac16(acc, s->x1,  c->b1);
+    acc = _dsp_mac16(acc, s->x2,  c->b2);
+    acc = _dsp_mac16(acc, s->y1,  c->a1);
+    acc = _dsp_mac16(acc, s->y2,  c->a2);
+    int16_t y = _dsp_round16(acc, 14);
+    s->x2 = s->x1;
+    s->x1 = sample;
+    s->y2 = s->y1;
+    s->y1 = y;
+    sample = y;                 // the output of one section is the input of the next.
+    c++;
+    s++;
+  }
+  return sample;
+}
+
+void BiquadFilter::process(const int16_t *in, int16_t *out, uint16_t count) {
+  while (count--) {
+    *out++ = process(*in++);
+  }
+}
+
+void BiquadFilter::reset() {
+  memset(_state, 0, _sections * sizeof(BiquadState));
+}
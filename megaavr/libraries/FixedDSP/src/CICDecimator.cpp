@@ -0,0 +1,43 @@
+#include "FixedDSP.h"
+
+/* The integrators overflow, and that's fine: the combs take differences, and as long as the output fits in 32 bits, the
+ * wraparound cancels out - which is why everything here is done on uint32_t, where overflow is defined. */
+
+bool CICDecimator::process(int16_t sample, int32_t &output) {
+  uint32_t x = (int32_t) sample;
+  uint8_t stages = _stages;
+  uint32_t *integrator = (uint32_t *) _integrator;
+  for (uint8_t i = 0; i < stages; i++) {
+    x += integrator[i];
+    integrator[i] = x;
+  }
+  if (++_count < _ratio) {
+    return false;
+  }
+  _count = 0;
+  uint32_t *comb = (uint32_t *) _comb;
+  for (uint8_t i = 0; i < stages; i++) {
+    uint32_t last = comb[i];
+    comb[i] = x;
+    x -= last;
+  }
+  output = (int32_t) x;
+  return true;
+}
+
+uint16_t CICDecimator::process(const int16_t *in, int32_t *out, uint16_t count) {
+  uint16_t outputs = 0;
+  while (count--) {
+    if (process(*in++, *out)) {
+      out++;
+      outputs++;
+    }
+  }
+  return outputs;
+}
+
+void CICDecimator::reset() {
+  memset(_integrator, 0, sizeof(_integrator));
+  memset(_comb, 0, sizeof(_comb));
+  _count = 0;
+}
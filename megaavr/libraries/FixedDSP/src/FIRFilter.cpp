@@ -0,0 +1,80 @@
+#include "FixedDSP.h"
+#include "dsp_asm.h"
+
+/* The history is a circular buffer, with _pos where the next sample goes. Rather than wrap the index inside the inner loop,
+ * we run the taps in two pieces: from the newest sample back to the start of the buffer, then from the end of the buffer
+ * back to the oldest. */
+
+int16_t FIRFilter::process(int16_t sample) {
+  if (!_taps) {                 // nothing to filter with, and the second piece below would run 255 times.
+    return 0;
+  }
+  uint8_t pos = _pos;
+  _state[pos] = sample;
+  const int16_t *c = _coeffs;
+  const int16_t *s = _state + pos;
+  int32_t acc = 0;
+  uint8_t n = pos + 1;
+  do {
+    acc = _dsp_mac16(acc, *s--, *c++);
+  } while (--n);
+  n = _taps - pos - 1;
+  s = _state + _taps - 1;
+  while (n) {
+    acc = _dsp_mac16(acc, *s--, *c++);
+    n--;
+  }
+  if (++pos == _taps) {
+    pos = 0;
+  }
+  _pos = pos;
+  return _dsp_round16(acc, 15);
+}
+
+void FIRFilter::process(const int16_t *in, int16_t *out, uint16_t count) {
+  while (count--) {
+    *out++ = process(*in++);
+  }
+}
+
+void FIRFilter::reset() {
+  memset(_state, 0, _taps * sizeof(int16_t));
+  _pos = 0;
+}
+
+int16_t FIRFilterQ7::process(int16_t sample) {
+  if (!_taps) {
+    return 0;
+  }
+  uint8_t pos = _pos;
+  _state[pos] = sample;
+  const int8_t  *c = _coeffs;
+  const int16_t *s = _state + pos;
+  int32_t acc = 0;
+  uint8_t n = pos + 1;
+  do {
+    acc = _dsp_mac8(acc, *s--, *c++);
+  } while (--n);
+  n = _taps - pos - 1;
+  s = _state + _taps - 1;
+  while (n) {
+    acc = _dsp_mac8(acc, *s--, *c++);
+    n--;
+  }
+  if (++pos == _taps) {
+    pos = 0;
+  }
+  _pos = pos;
+  return _dsp_round16(acc, 7);
+}
+
+void FIRFilterQ7::process(const int16_t *in, int16_t *out, uint16_t count) {
+  while (count--) {
+    *out++ = process(*in++);
+  }
+}
+
+void FIRFilterQ7::reset() {
+  memset(_state, 0, _taps * sizeof(int16_t));
+  _pos = 0;
+}
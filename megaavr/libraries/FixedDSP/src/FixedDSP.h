@@ -0,0 +1,163 @@
+/* FixedDSP.h - fixed point filters for DxCore: FIR, biquad IIR, CIC decimation, exponential and moving averages, and a
+ * running median, fast enough to filter ADC data at tens of kHz.
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * Samples are int16_t. That can be analogRead() results as they are, or anything else - the filters don't care what the
+ * units are. Coefficients are fixed point fractions: Q15 (value / 32768) for FIR filters, Q7 (value / 128) for the smaller,
+ * faster FIR filter, and Q14 (value / 16384, so -2 to +2) for biquads, whose feedback coefficients are often more than 1.
+ * The Q15(), Q14() and Q7() macros convert constants, at compile time.
+ *
+ * Each filter has process(sample), which takes one sample and returns the output, and process(in, out, count), which does a
+ * whole block - such as one from ADCStream - and may be done in place (in == out). Products are summed at full precision in
+ * 32 bits, and rounded and saturated to 16 bits only at the output.
+ *
+ * Filters keep their history in buffers you supply, so you can size them, and no memory is allocated.
+ */
+
+#ifndef FIXEDDSP_H
+#define FIXEDDSP_H
+#include <Arduino.h>
+
+#define Q15(x) ((int16_t)((x) >= 0.99997 ? 32767 : ((x) * 32768.0 + ((x) >= 0 ? 0.5 : -0.5))))
+#define Q14(x) ((int16_t)((x) >= 1.99994 ? 32767 : ((x) * 16384.0 + ((x) >= 0 ? 0.5 : -0.5))))
+#define Q7(x)  ((int8_t) ((x) >= 0.99219 ?   127 : ((x) *   128.0 + ((x) >= 0 ? 0.5 : -0.5))))
+
+/* FIR filter with Q15 coefficients. coeffs[0] multiplies the newest sample. state needs room for taps samples. */
+class FIRFilter {
+  public:
+    FIRFilter(const int16_t *coeffs, int16_t *state, uint8_t taps) : _coeffs(coeffs), _state(state), _taps(taps) {
+      reset();
+    }
+    int16_t process(int16_t sample);
+    void process(const int16_t *in, int16_t *out, uint16_t count);
+    void reset();
+
+  private:
+    const int16_t *_coeffs;
+    int16_t       *_state;
+    uint8_t        _taps;
+    uint8_t        _pos = 0;
+};
+
+/* FIR filter with Q7 coefficients - 2 multiplies per tap instead of 4, for when 8 bits of coefficient is enough (a moving
+ * average or a gentle low pass is; a sharp cutoff or deep stopband isn't). */
+class FIRFilterQ7 {
+  public:
+    FIRFilterQ7(const int8_t *coeffs, int16_t *state, uint8_t taps) : _coeffs(coeffs), _state(state), _taps(taps) {
+      reset();
+    }
+    int16_t process(int16_t sample);
+    void process(const int16_t *in, int16_t *out, uint16_t count);
+    void reset();
+
+  private:
+    const int8_t *_coeffs;
+    int16_t      *_state;
+    uint8_t       _taps;
+    uint8_t       _pos = 0;
+};
+
+/* Biquad coefficients, Q14. y = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2] - note that a1 and a2 are added, so
+ * they have the opposite sign of the usual textbook form (as in CMSIS-DSP). */
+typedef struct {
+  int16_t b0, b1, b2, a1, a2;
+} BiquadCoeffs;
+
+typedef struct {
+  int16_t x1, x2, y1, y2;
+} BiquadState;
+
+/* A cascade of sections biquads (direct form I), each with its own coefficients and state. Higher order filters are built
+ * from a cascade of second order sections, rather than one high order section, which fixed point can't do stably. */
+class BiquadFilter {
+  public:
+    BiquadFilter(const BiquadCoeffs *coeffs, BiquadState *state, uint8_t sections) : _coeffs(coeffs), _state(state), _sections(sections) {
+      reset();
+    }
+    int16_t process(int16_t sample);
+    void process(const int16_t *in, int16_t *out, uint16_t count);
+    void reset();
+
+  private:
+    const BiquadCoeffs *_coeffs;
+    BiquadState        *_state;
+    uint8_t             _sections;
+};
+
+/* CIC (cascaded integrator-comb) decimator: stages (1 to 4) of integrators at the input rate, and the same number of combs at
+ * the output rate, which is ratio times lower. No multiplies at all. The gain is ratio^stages, so the output has that many
+ * more bits than the input: 16 + stages * log2(ratio) must not be more than 32. */
+#define CIC_MAX_STAGES 4
+
+class CICDecimator {
+  public:
+    CICDecimator(uint8_t stages, uint8_t ratio) : _stages(stages > CIC_MAX_STAGES ? CIC_MAX_STAGES : stages), _ratio(ratio) {
+      reset();
+    }
+    // Returns true, and sets output, once every ratio samples.
+    bool process(int16_t sample, int32_t &output);
+    // Returns the number of outputs written to out, which needs room for count / ratio + 1.
+    uint16_t process(const int16_t *in, int32_t *out, uint16_t count);
+    void reset();
+
+  private:
+    uint8_t _stages;
+    uint8_t _ratio;
+    uint8_t _count;
+    int32_t _integrator[CIC_MAX_STAGES];
+    int32_t _comb[CIC_MAX_STAGES];
+};
+
+/* Exponential moving average: y += (x - y) / 2^shift. The time constant is about 2^shift samples. The state is kept with 15
+ * fractional bits, so small steps aren't lost to rounding, even with a large shift - 15 rather than 16, so that x - y can't
+ * overflow 32 bits, even with x and y at opposite ends of the 16-bit range. */
+class EMAFilter {
+  public:
+    EMAFilter(uint8_t shift) : _shift(shift) {}
+    int16_t process(int16_t sample);
+    void process(const int16_t *in, int16_t *out, uint16_t count);
+    void reset(int16_t value = 0) {
+      _state = (int32_t) value * 32768;
+    }
+
+  private:
+    uint8_t _shift;
+    int32_t _state = 0;
+};
+
+/* Moving average of the last length samples, kept in buffer. A running sum, so it costs the same however long it is. If the
+ * length is a power of 2, the average is a shift; otherwise, it's a division, which is a lot slower. */
+class MovingAverage {
+  public:
+    MovingAverage(int16_t *buffer, uint16_t length);
+    int16_t process(int16_t sample);
+    void process(const int16_t *in, int16_t *out, uint16_t count);
+    void reset();
+
+  private:
+    int16_t *_buffer;
+    uint16_t _length;
+    uint16_t _pos = 0;
+    int32_t  _sum = 0;
+    uint8_t  _shift;  // log2(length), or 0xFF if it isn't a power of 2.
+};
+
+/* Running median of the last length samples (odd, up to MEDIAN_MAX_LENGTH) - gets rid of spikes that an average would only
+ * smear out. buffer needs room for 2 * length samples: the history, and the same samples in order. */
+#define MEDIAN_MAX_LENGTH 31
+
+class MedianFilter {
+  public:
+    MedianFilter(int16_t *buffer, uint8_t length);
+    int16_t process(int16_t sample);
+    void process(const int16_t *in, int16_t *out, uint16_t count);
+    void reset();
+
+  private:
+    int16_t *_buffer;
+    uint8_t  _length;
+    uint8_t  _pos = 0;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/* dsp_asm.h - the multiply-accumulate kernels that everything in FixedDSP is built on, in inline assembly using the hardware
+ * multiplier. Not meant to be included by sketches.
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * The compiler won't do a 16 x 16 -> 32 bit signed multiply without promoting both to 32 bits and calling __mulsi3, which
+ * does 10 multiplies and a lot of bookkeeping to get the same answer; the 16 x 8 case is no better. With muls and mulsu, a
+ * signed 16 x 16 MAC is 4 multiplies, and 16 x 8 is 2 (Atmel AVR201). The trick to sign extending each partial product is
+ * that mul* leaves bit 15 of the product in carry, so "sbc top, zero" right after it adds the sign extension for free.
+ *
+ * muls needs its operands in r16-r31, and mulsu in r16-r23, hence the "a" constraints.
+ */
+
+#ifndef DSP_ASM_H
+#define DSP_ASM_H
+#include <Arduino.h>
+
+// acc + a * b, all signed.
+static inline __attribute__((always_inline)) int32_t _dsp_mac16(int32_t acc, int16_t a, int16_t b) {
+  uint8_t zero;
+  __asm__ (
+    "clr        %[z]"             "\n\t" // no __zero_reg__ for us - mul writes r1.
+    "muls       %B[a],   %B[b]"   "\n\t" // ah * bh -> bytes 2 and 3
+    "add        %C[acc],    r0"   "\n\t"
+    "adc        %D[acc],    r1"   "\n\t"
+    "mul        %A[a],   %A[b]"   "\n\t" // al * bl (unsigned) -> bytes 0 and 1
+    "add        %A[acc],    r0"   "\n\t"
+    "adc        %B[acc],    r1"   "\n\t"
+    "adc        %C[acc],  %[z]"   "\n\t"
+    "adc        %D[acc],  %[z]"   "\n\t"
+    "mulsu      %B[a],   %A[b]"   "\n\t" // ah * bl -> bytes 1 and 2, sign in carry
+    "sbc        %D[acc],  %[z]"   "\n\t" // sign extend into byte 3
+    "add        %B[acc],    r0"   "\n\t"
+    "adc        %C[acc],    r1"   "\n\t"
+    "adc        %D[acc],  %[z]"   "\n\t"
+    "mulsu      %B[b],   %A[a]"   "\n\t" // bh * al -> bytes 1 and 2, sign in carry
+    "sbc        %D[acc],  %[z]"   "\n\t"
+    "add        %B[acc],    r0"   "\n\t"
+    "adc        %C[acc],    r1"   "\n\t"
+    "adc        %D[acc],  %[z]"   "\n\t"
+    "clr        r1"               "\n\t" // put __zero_reg__ back
+    : [acc] "+r" (acc), [z] "=&r" (zero)
+    : [a] "a" (a), [b] "a" (b)
+    : "r0");
+  return acc;
+}
+
+// acc + a * c, all signed, c 8 bits.
+static inline __attribute__((always_inline)) int32_t _dsp_mac8(int32_t acc, int16_t a, int8_t c) {
+  uint8_t zero;
+  __asm__ (
+    "clr        %[z]"             "\n\t"
+    "muls       %B[a],    %[c]"   "\n\t" // ah * c -> bytes 1 and 2, sign in carry
+    "sbc        %D[acc],  %[z]"   "\n\t"
+    "add        %B[acc],    r0"   "\n\t"
+    "adc        %C[acc],    r1"   "\n\t"
+    "adc        %D[acc],  %[z]"   "\n\t"
+    "mulsu      %[c],    %A[a]"   "\n\t" // c * al -> bytes 0 and 1, sign in carry
+    "sbc        %C[acc],  %[z]"   "\n\t" // sign extend into bytes 2 and 3
+    "sbc        %D[acc],  %[z]"   "\n\t"
+    "add        %A[acc],    r0"   "\n\t"
+    "adc        %B[acc],    r1"   "\n\t"
+    "adc        %C[acc],  %[z]"   "\n\t"
+    "adc        %D[acc],  %[z]"   "\n\t"
+    "clr        r1"               "\n\t"
+    : [acc] "+r" (acc), [z] "=&r" (zero)
+    : [a] "a" (a), [c] "a" (c)
+    : "r0");
+  return acc;
+}
+
+/* Round an accumulator with frac fractional bits to the nearest integer, and saturate it to 16 bits. It's always inlined, and
+ * frac is always a constant (15, 14 or 7), so the compiler can use a fixed shift sequence, not a loop. */
+static inline __attribute__((always_inline)) int16_t _dsp_round16(int32_t acc, uint8_t frac) {
+  acc += (1L << (frac - 1));
+  if (acc >= (32768L << frac)) {
+    return 32767;
+  }
+  if (acc < -(32768L << frac)) {
+    return -32768;
+  }
+  return acc >> frac;
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+  SPI Async Transfer
+
+  Shows how to send a block of data with SPI.transferAsync(), which sends it from the SPI interrupt
+  while loop() keeps running, and calls back when it's done.
+
+  A 512-byte block is sent to a device selected by CS_PIN every 100 ms - a line of pixels for a
+  display, or a page for a flash chip, would be sent the same way. While each block is going out,
+  loop() counts how many times it ran, and prints that once the block has been sent, to show that
+  it wasn't held up.
+
+  Circuit: MOSI, SCK and CS_PIN to the device. The sketch runs without one; the data just goes nowhere.
+*/
+
+#include <SPI.h>
+
+#define CS_PIN PIN_PD0
+
+uint8_t block[512];
+volatile bool blockSent = false;
+uint32_t lastSent = 0;
+uint32_t loops = 0;
+
+void sent() {                 // called from the interrupt - keep it short
+  digitalWriteFast(CS_PIN, HIGH);
+  SPI.endTransaction();
+  blockSent = true;
+}
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(CS_PIN, OUTPUT);
+  digitalWriteFast(CS_PIN, HIGH);
+  for (uint16_t i = 0; i < sizeof(block); i++) {
+    block[i] = i;
+  }
+  SPI.begin();
+}
+
+void loop() {
+  loops++;
+  if (millis() - lastSent >= 100 && !SPI.transferPending()) {
+    lastSent = millis();
+    loops = 0;
+    SPI.beginTransaction(SPISettings(1000000, MSBFIRST, SPI_MODE0));
+    digitalWriteFast(CS_PIN, LOW);
+    SPI.transferAsync(block, NULL, sizeof(block), sent);   // returns straight away
+  }
+  if (blockSent) {
+    blockSent = false;
+    Serial.print("Sent 512 bytes, loop() ran ");
+    Serial.print(loops);
+    Serial.println(" times meanwhile");
+  }
+}
@@ -307,6 +307,9 @@ class SPISettings {
     friend class SPIClass;
 };
 
+// Called from the SPI interrupt when a transferAsync() is done.
+typedef void (*SPIAsyncCallback)(void);
+
 class SPIClass {
   public:
     SPIClass();
@@ -314,6 +317,8 @@ class SPIClass {
     byte transfer(uint8_t data);
     uint16_t transfer16(uint16_t data);
     void transfer(void *buf, size_t count);
+    bool transferAsync(const void *txBuffer, void *rxBuffer, size_t count, SPIAsyncCallback callback = NULL);
+    bool transferPending(void);
 
     // Transaction Functions
     void usingInterrupt(uint8_t interruptNumber);
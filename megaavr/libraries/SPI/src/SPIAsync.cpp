@@ -0,0 +1,120 @@
+/*
+ * Interrupt driven buffer transfers for the SPI library for DxCore.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/* This is in its own file, and the library is linked as an archive, so that the SPI interrupt is only defined if
+ * transferAsync() is used - anything else that wants that interrupt (like an SPI slave written with the registers)
+ * can still have it.
+ *
+ * The SPI is put in buffered mode for the transfer, where there is a byte of transmit buffer in front of the shift
+ * register, and two bytes of receive buffer. We keep two bytes in flight: one in the shift register, one in the buffer,
+ * and each time a byte is received, we read it and write the next. Since we never have more than two outstanding, the
+ * receive buffer can't overflow however late the interrupt is, and the bus only goes idle between bytes if the interrupt
+ * is held off for longer than a byte takes. Each interrupt picks up every byte that has arrived.
+ */
+
+#include "SPI.h"
+#include <Arduino.h>
+
+static struct {
+  SPI_t            *module;
+  const uint8_t    *tx;       // NULL to send 0xFF
+  uint8_t          *rx;       // NULL to throw away what's received
+  size_t            txLeft;
+  size_t            rxLeft;
+  volatile uint8_t  busy;     // one byte, so it can be read without turning interrupts off
+  uint8_t           ctrlb;    // CTRLB before we turned buffered mode on
+  SPIAsyncCallback  callback;
+} spi_async;
+
+static void spi_async_irq(void) {
+  SPI_t *module = spi_async.module;
+  size_t rxLeft = spi_async.rxLeft;
+  while (module->INTFLAGS & SPI_RXCIF_bm) {
+    uint8_t in = module->DATA;
+    if (spi_async.rx != NULL) {
+      *spi_async.rx++ = in;
+    }
+    if (spi_async.txLeft) {
+      spi_async.txLeft--;
+      module->DATA = (spi_async.tx != NULL) ? *spi_async.tx++ : 0xFF;
+    }
+    if (--rxLeft == 0) {
+      module->INTCTRL = 0;
+      module->CTRLB   = spi_async.ctrlb;
+      spi_async.busy  = 0;
+      if (spi_async.callback != NULL) {
+        spi_async.callback();     // may start another transfer
+      }
+      return;
+    }
+  }
+  spi_async.rxLeft = rxLeft;
+}
+
+bool SPIClass::transferAsync(const void *txBuffer, void *rxBuffer, size_t count, SPIAsyncCallback callback) {
+  // SPI not started, nothing to do, one already going, or interrupts off (as in a transaction after usingInterrupt())
+  uint8_t oldSREG = SREG;
+  if (!initialized || count == 0 || !(oldSREG & CPU_I_bm)) {
+    return false;
+  }
+  cli();                                      // claim it in one go, so a callback can't start one in between
+  if (spi_async.busy) {
+    SREG = oldSREG;
+    return false;
+  }
+  spi_async.busy = 1;
+  SREG = oldSREG;
+  #ifdef SPI1
+    SPI_t *module = _hwspi_module;
+  #else
+    SPI_t *module = &SPI0;
+  #endif
+  spi_async.module   = module;
+  spi_async.tx       = (const uint8_t *) txBuffer;
+  spi_async.rx       = (uint8_t *) rxBuffer;
+  spi_async.callback = callback;
+  spi_async.ctrlb    = module->CTRLB;
+  module->CTRLB = spi_async.ctrlb | SPI_BUFEN_bm | SPI_BUFWR_bm;
+  while (module->INTFLAGS & SPI_RXCIF_bm) {   // in case anything was left in the receive buffer
+    (void) module->DATA;
+  }
+  uint8_t first = (count > 1) ? 2 : 1;        // fill the shift register and the transmit buffer
+  spi_async.txLeft = count - first;
+  cli();
+  spi_async.rxLeft = count;
+  while (first--) {
+    module->DATA = (spi_async.tx != NULL) ? *spi_async.tx++ : 0xFF;
+  }
+  module->INTCTRL = SPI_RXCIE_bm;
+  SREG = oldSREG;
+  return true;
+}
+
+bool SPIClass::transferPending(void) {
+  return spi_async.busy;
+}
+
+ISR(SPI0_INT_vect) {
+  spi_async_irq();
+}
+
+#if defined(SPI1)
+  ISR(SPI1_INT_vect) {
+    spi_async_irq();
+  }
+#endif
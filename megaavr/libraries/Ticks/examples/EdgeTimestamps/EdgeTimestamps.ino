@@ -0,0 +1,58 @@
+/* EdgeTimestamps - timestamps rising edges on a pin to the nearest clock cycle.
+ *
+ * TCB0 and TCB1 are cascaded into a 32-bit counter running at F_CPU. Every rising edge on PIN_PA2 is routed through the
+ * event system to the capture input of both, and the capture interrupt stores the 32-bit timestamp in a ring buffer.
+ * The loop prints the period between edges in ticks and in nanoseconds, and how long ticks() and micros() take to call.
+ * Connect a signal of up to a few tens of kHz to PA2. The millis timer must not be TCB0 or TCB1 - choose another in the
+ * tools menu (the default on most parts is TCB2).
+ */
+#include <Event.h>
+#include <Ticks.h>
+
+#define EDGE_BUFFER 16          // power of 2
+volatile uint32_t edges[EDGE_BUFFER];
+volatile uint8_t edgeHead = 0;
+uint8_t edgeTail = 0;
+
+ISR(TCB0_INT_vect) {
+  uint8_t h = edgeHead;
+  edges[h] = Ticks.captured(); // this clears the interrupt flag.
+  edgeHead = (h + 1) & (EDGE_BUFFER - 1);
+}
+
+void setup() {
+  Serial.begin(115200);
+  if (!Ticks.begin(TCB0, TCB1)) {
+    Serial.println("Could not start Ticks - is millis on TCB0 or TCB1?");
+    while (1);
+  }
+  Event &edge = Event::assign_generator_pin(PIN_PA2);
+  edge.start();
+  Ticks.captureOn(edge, false, true);
+
+  uint32_t start = ticks();
+  uint32_t t = ticks();
+  Serial.print("ticks() takes ");
+  Serial.print(t - start);
+  Serial.println(" clocks");
+  start = ticks();
+  t = micros();
+  t = ticks();
+  Serial.print("micros() takes ");
+  Serial.print(t - start);
+  Serial.println(" clocks, including one ticks()");
+}
+
+void loop() {
+  static uint32_t last = 0;
+  while (edgeTail != edgeHead) {
+    uint32_t t = edges[edgeTail];
+    edgeTail = (edgeTail + 1) & (EDGE_BUFFER - 1);
+    uint32_t period = t - last;
+    last = t;
+    Serial.print(period);
+    Serial.print(" ticks, ");
+    Serial.print(Ticks.toNanos(period));
+    Serial.println(" ns");
+  }
+}
@@ -0,0 +1,84 @@
+#include "Ticks.h"
+
+TicksTimer Ticks;
+
+static bool isMillisTimer(TCB_t &timer) {
+  #if defined(MILLIS_USE_TCB)
+    return (MILLIS_TIMER - TIMERB0) == (uint8_t)(&timer - &TCB0);
+  #else
+    (void) timer;
+    return false;
+  #endif
+}
+
+bool TicksTimer::begin(TCB_t &low, TCB_t &high, bool half_speed) {
+  if (&low == &high || isMillisTimer(low) || isMillisTimer(high)) {
+    return false;
+  }
+  end();
+  Event &channel = Event::assign_generator(Event::gen_from_peripheral(low, 1)); // 1 = OVF
+  if (channel.get_channel_number() == 255) {
+    return false;                                                               // Every channel is in use.
+  }
+  low.CTRLA   = 0;
+  high.CTRLA  = 0;
+  low.CTRLB   = TCB_CNTMODE_CAPT_gc;
+  high.CTRLB  = TCB_CNTMODE_CAPT_gc;
+  low.EVCTRL  = 0;
+  high.EVCTRL = 0;
+  low.INTCTRL = 0;
+  high.INTCTRL = 0;
+  low.INTFLAGS = TCB_CAPT_bm | TCB_OVF_bm;
+  high.INTFLAGS = TCB_CAPT_bm | TCB_OVF_bm;
+  low.CNT     = 0;
+  high.CNT    = 0;
+  channel.set_user(Event::user_from_peripheral(high, 1));                       // 1 = COUNT
+  channel.start();
+  _channel = &channel;
+  _shift = half_speed ? 1 : 0;
+  _high = &high;
+  high.CTRLA = TCB_CLKSEL_EVENT_gc | TCB_CASCADE_bm | TCB_ENABLE_bm;
+  low.CTRLA = (half_speed ? TCB_CLKSEL_DIV2_gc : TCB_CLKSEL_DIV1_gc) | TCB_ENABLE_bm;
+  _low = &low;
+  return true;
+}
+
+void TicksTimer::end() {
+  if (_low == NULL) {
+    return;
+  }
+  captureOff();
+  _low->CTRLA = 0;
+  _high->CTRLA = 0;
+  Event::clear_user(Event::user_from_peripheral(*_high, 1));
+  _channel->stop();
+  _channel->set_generator(event::gen::disable);
+  _low = NULL;
+  _high = NULL;
+  _channel = NULL;
+}
+
+void TicksTimer::captureOn(Event &channel, bool falling, bool interrupt) {
+  if (_low == NULL) {
+    return;
+  }
+  uint8_t evctrl = TCB_CAPTEI_bm | (falling ? TCB_EDGE_bm : 0);
+  channel.set_user(Event::user_from_peripheral(*_low, 0));                      // 0 = CAPT
+  channel.set_user(Event::user_from_peripheral(*_high, 0));
+  _low->EVCTRL = evctrl;
+  _high->EVCTRL = evctrl;
+  _low->INTFLAGS = TCB_CAPT_bm;
+  _high->INTFLAGS = TCB_CAPT_bm;
+  _low->INTCTRL = interrupt ? TCB_CAPT_bm : 0;
+}
+
+void TicksTimer::captureOff() {
+  if (_low == NULL) {
+    return;
+  }
+  _low->INTCTRL = 0;
+  _low->EVCTRL = 0;
+  _high->EVCTRL = 0;
+  Event::clear_user(Event::user_from_peripheral(*_low, 0));
+  Event::clear_user(Event::user_from_peripheral(*_high, 0));
+}
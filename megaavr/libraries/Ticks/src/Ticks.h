@@ -0,0 +1,96 @@
+/* Ticks.h - 32-bit timestamp counter from two cascaded TCBs, for DxCore
+ * This library is free software released under LGPL 2.1.
+ * See License.md for more information.
+ *
+ * One TCB counts the system clock (or half of it), and its overflow is routed through the event system to the count input of
+ * a second TCB, which holds the high 16 bits. Both run in input capture mode, so they count from 0 to 0xFFFF and wrap. That
+ * gives a 32-bit count that wraps every 2^32 clocks (179 seconds at 24 MHz), which ticks() can read without doing any math.
+ * Compare that to micros(), which has to combine the millis count, the fractional count and the timer count, and scale them.
+ *
+ * Because both timers are in capture mode, routing an event to the capture input of both captures all 32 bits at once, in
+ * hardware. The CASCADE bit on the high timer delays its capture by one clock, so the two halves always agree.
+ *
+ * Reading the count takes three 16-bit reads: low, high, low. If the low half wrapped between them, or it wrapped so recently
+ * that the overflow event might not yet have reached the high timer, we read it again. Interrupts are disabled during the
+ * reads, as the TEMP register used for 16-bit reads is not protected.
+ */
+
+#ifndef TICKS_H
+#define TICKS_H
+#include <Arduino.h>
+#include <Event.h>
+
+class TicksTimer {
+  public:
+    TicksTimer() {}
+    // low counts the clock, high counts overflows from low. Returns false if either is the millis timer, they're the same
+    // timer, or no event channel is available.
+    bool begin(TCB_t &low, TCB_t &high, bool half_speed = false);
+    void end();
+
+    inline uint32_t __attribute__((always_inline)) read() {
+      uint16_t lo, lo2, hi;
+      if (_low == NULL) {
+        return 0;
+      }
+      uint8_t oldSREG = SREG;
+      cli();
+      do {
+        lo  = _low->CNT;
+        hi  = _high->CNT;
+        lo2 = _low->CNT;
+      } while (lo2 < lo || lo < 4); // wrapped during the reads, or the overflow might still be on its way to the high timer
+      SREG = oldSREG;
+      return ((uint32_t)hi << 16) | lo;
+    }
+
+    // Capture the count on both timers when the event channel fires. If interrupt is true, the CAPT interrupt of the low timer
+    // is enabled, and you must define an ISR for it (ex, ISR(TCB0_INT_vect) if TCB0 is the low timer) that calls captured().
+    void captureOn(Event &channel, bool falling = false, bool interrupt = false);
+    void captureOff();
+    bool captureReady() {
+      return _low && (_low->INTFLAGS & TCB_CAPT_bm);
+    }
+    // Reading the captured value clears the capture flag.
+    uint32_t captured() {
+      uint8_t oldSREG = SREG;
+      cli();
+      uint16_t hi = _high->CCMP;
+      uint16_t lo = _low->CCMP;
+      SREG = oldSREG;
+      return ((uint32_t)hi << 16) | lo;
+    }
+
+    /* Conversions. These are only valid for whole-megahertz values of F_CPU, which is all that the core supports anyway.
+     * toNanos() wraps after 2^32 ns (4.29 seconds), so use it on the difference between two timestamps, not on a timestamp. */
+    uint8_t ticksPerMicro() {
+      return (F_CPU / 1000000UL) >> _shift;
+    }
+    uint32_t toMicros(uint32_t t) {
+      uint32_t q = t / (F_CPU / 1000000UL);
+      uint8_t  r = t - q * (F_CPU / 1000000UL);
+      return (q << _shift) + ((uint16_t)r << _shift) / (uint8_t)(F_CPU / 1000000UL);
+    }
+    uint32_t toNanos(uint32_t t) {
+      uint32_t q = t / (F_CPU / 1000000UL);
+      uint8_t  r = t - q * (F_CPU / 1000000UL);
+      return (q * 1000 + ((uint16_t)r * 1000U) / (uint8_t)(F_CPU / 1000000UL)) << _shift;
+    }
+    uint32_t microsToTicks(uint32_t us) {
+      return (us * (F_CPU / 1000000UL)) >> _shift;
+    }
+
+  private:
+    TCB_t *_low = NULL;
+    TCB_t *_high = NULL;
+    Event *_channel = NULL;
+    uint8_t _shift = 0;
+};
+
+extern TicksTimer Ticks;
+
+inline uint32_t __attribute__((always_inline)) ticks() {
+  return Ticks.read();
+}
+
+#endif
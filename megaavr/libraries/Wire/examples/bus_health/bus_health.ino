@@ -0,0 +1,106 @@
+/* Wire Bus Health
+ *
+ * Demonstrates the bus scan, recovery and statistics features of the Wire library.
+ *
+ * At startup, the bus is checked; if something is holding SDA low (as a client that was
+ * partway through sending a byte when the power glitched will) it is freed with recoverBus().
+ * Then the bus is scanned, and every client found is read from once a second. Statistics
+ * are kept for all of this, with automatic recovery if the bus gets stuck, and printed
+ * every 10 seconds: how many transactions ended how, how long they took, how busy the bus
+ * was, and which clients had trouble.
+ *
+ * Pullup resistors must be connected between both data lines and Vcc.
+ * See the Wire library README.md for more information.
+ */
+
+#define MySerial Serial
+
+#include <Wire.h>
+
+twiStats stats;
+twiAddressStats perAddress[128];
+uint8_t clients[16];
+uint8_t clientCount = 0;
+uint32_t statsSince;
+
+void setup() {
+  MySerial.begin(115200);
+  Wire.begin();
+  if (Wire.checkPinLevels() != 0x03) {
+    MySerial.println("Bus stuck, recovering");
+    if (!Wire.recoverBus()) {
+      MySerial.println("Still stuck - check wiring and pullups");
+    }
+  }
+  clientCount = Wire.scan(clients, 16);
+  if (clientCount == TWI_SCAN_BUS_ERROR) {
+    MySerial.println("Scan failed");
+    clientCount = 0;
+  }
+  if (clientCount > 16) {
+    clientCount = 16;
+  }
+  MySerial.print("Found ");
+  MySerial.print(clientCount);
+  MySerial.println(" clients");
+  for (uint8_t i = 0; i < clientCount; i++) {
+    MySerial.printHex(clients[i]);
+    MySerial.println();
+  }
+  stats.perAddress  = perAddress;
+  stats.autoRecover = true;
+  Wire.setStats(&stats);
+  statsSince = micros();
+}
+
+void loop() {
+  uint8_t data[2];
+  for (uint8_t i = 0; i < clientCount; i++) {
+    Wire.readFrom(clients[i], data, 2);
+  }
+  delay(1000);
+  uint32_t elapsed = micros() - statsSince;
+  if (elapsed >= 10000000UL) {
+    MySerial.print("Transactions: ");
+    MySerial.print(stats.transactions);
+    MySerial.print(", NACKs: ");
+    MySerial.print(stats.nacks);
+    MySerial.print(", timeouts: ");
+    MySerial.print(stats.timeouts);
+    MySerial.print(", arbitration lost: ");
+    MySerial.print(stats.arbLost);
+    MySerial.print(", recoveries: ");
+    MySerial.println(stats.recoveries);
+    MySerial.print("Bus busy ");
+    MySerial.print(stats.busyMicros / (elapsed / 1000));
+    MySerial.println(" us per ms");
+    for (uint8_t n = 0; n < TWI_STATS_BINS; n++) {
+      if (n < TWI_STATS_BINS - 1) {
+        MySerial.print("  < ");
+        MySerial.print(64U << n);
+      } else {             // the last one is everything longer
+        MySerial.print(" >= ");
+        MySerial.print(64U << (n - 1));
+      }
+      MySerial.print(" us: ");
+      MySerial.println(stats.latency[n]);
+    }
+    for (uint8_t a = 0; a < 128; a++) {
+      if (perAddress[a].nacks || perAddress[a].timeouts || perAddress[a].arbLost) {
+        MySerial.printHex(a);
+        MySerial.print(": ");
+        MySerial.print(perAddress[a].nacks);
+        MySerial.print(" NACKs, ");
+        MySerial.print(perAddress[a].timeouts);
+        MySerial.print(" timeouts, ");
+        MySerial.print(perAddress[a].arbLost);
+        MySerial.println(" arbitration lost");
+      }
+    }
+    memset(&perAddress, 0, sizeof(perAddress));
+    stats = twiStats();   // start over
+    stats.perAddress  = perAddress;
+    stats.autoRecover = true;
+    statsSince = micros();
+  }
+}
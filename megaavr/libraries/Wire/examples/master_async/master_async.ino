@@ -0,0 +1,65 @@
+/* Wire Master Async
+ *
+ * Demonstrates queued, interrupt driven master transactions.
+ * Reads data from an I2C/TWI slave device without waiting for it.
+ * Refer to the "Wire Slave Write" example for use with this
+ *
+ * Every 100 ms, a transaction asking the slave at 0x54 for 4 bytes is queued. The
+ * TWI master interrupt carries it out while loop() keeps running, and the callback
+ * is called from the interrupt when it's done. loop() counts how many times it ran
+ * in the meantime, to show that it wasn't held up; when using together with the
+ * complementary example, the slave sends its millis() value.
+ *
+ * To use this, you need to connect the SCL and SDA pins of this device to the
+ * SCL and SDA pins of a second device running the Wire Slave Write example.
+ *
+ * Pullup resistors must be connected between both data lines and Vcc.
+ * See the Wire library README.md for more information.
+ */
+
+#define MySerial Serial
+
+#include <Wire.h>
+
+uint8_t rxBuffer[4];
+twiTransaction readMillis;
+volatile bool done = false;
+uint32_t lastQueued = 0;
+uint32_t loops = 0;
+
+void readDone(twiTransaction *t) {  // called from the interrupt - keep it short
+  (void) t;
+  done = true;
+}
+
+void setup() {
+  Wire.begin();                     // initialize master
+  MySerial.begin(115200);
+  readMillis.address    = 0x54;
+  readMillis.readBuffer = rxBuffer;
+  readMillis.readLength = 4;
+  readMillis.callback   = readDone;
+}
+
+void loop() {
+  loops++;
+  if (millis() - lastQueued >= 100 && readMillis.status != TWI_TRANSACTION_PENDING) {
+    lastQueued = millis();
+    loops = 0;
+    Wire.queueTransaction(&readMillis);   // returns straight away
+  }
+  if (done) {
+    done = false;
+    if (readMillis.status == TWI_ERR_SUCCESS) {
+      uint32_t ms;
+      memcpy(&ms, rxBuffer, 4);
+      MySerial.print(ms);                 // print the milliseconds from Slave
+    } else {
+      MySerial.print("Error 0x");
+      MySerial.print(readMillis.status, HEX);
+    }
+    MySerial.print(", loop() ran ");
+    MySerial.print(loops);
+    MySerial.println(" times while waiting");
+  }
+}
@@ -0,0 +1,56 @@
+/* Wire Register Map
+ *
+ * Demonstrates use of the Wire library
+ * Does the same as the Wire Register Model example - a slave with "registers" and an
+ * autoincrementing pointer, like most I2C devices - but with setRegisterMap(), so the
+ * library does it all in the slave interrupt, and there are no handlers to write.
+ * Refer to the "Wire Register Model Master" example for use with this
+ *
+ * A write sets the pointer with its first byte, and any more bytes are written to the
+ * registers from there on. A read reads the registers from the pointer on. The pointer
+ * increments after each byte, and wraps around after the last register.
+ *
+ * Only bits that are a 1 in WriteMask can be written. The others will remain unchanged.
+ * 0-4 are fully writeable
+ * the 5 low bits of 5 are writeable
+ * 6 and 7 are fully writeable,
+ * 8-11 only allow the 2 low bits in each nybble to be written
+ * 12-15 are read-only
+ * 16 and 17 allow only the low nybble to be written
+ * 18 and 19 allow only the high nybble to be written.
+ * 20-31 are read-only. Here, 20 and 21 hold millis(), updated by loop().
+ *
+ * Registers 4 and 5 are the low and high bytes of the time delay used for the blinking.
+ * So by default it's 0x0504 ms, or 1284 ms.
+ */
+#include <Wire.h>
+volatile uint8_t DeviceRegisters[32] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                                        0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+                                        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+                                        0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F
+                                       };
+const uint8_t WriteMask[32]          = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F, 0xFF, 0xFF,
+                                        0x33, 0x33, 0x33, 0x33, 0x00, 0x00, 0x00, 0x00,
+                                        0x0F, 0x0F, 0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00,
+                                        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+                                       };
+
+void setup() {
+  Wire.setRegisterMap(DeviceRegisters, 32, WriteMask);
+  Wire.begin(0x69);
+  pinMode(LED_BUILTIN, OUTPUT);
+}
+
+void loop() {
+  static uint32_t lastBlinkAt = 0;
+  uint16_t ms = millis();
+  cli();                          // so the master can't read one byte of the old value and one of the new
+  DeviceRegisters[20] = ms;
+  DeviceRegisters[21] = ms >> 8;
+  uint16_t delaytime = DeviceRegisters[4] + ((uint16_t)DeviceRegisters[5] << 8);
+  sei();
+  if (millis() - lastBlinkAt > delaytime) {
+    lastBlinkAt = millis();
+    digitalWrite(LED_BUILTIN, CHANGE);
+  }
+}
@@ -48,6 +48,14 @@ void restoreSleep(uint8_t moduelAddr);
 TwoWire* twi0_wire;
 TwoWire* twi1_wire;
 
+/* The master ISRs call this, which queueTransaction() sets, rather than HandleMasterIRQ() directly, so that the
+ * state machine is only linked in if a sketch queues transactions. */
+static void (*twi_master_handler)(TwoWire *wire_m) = NULL;
+// Likewise, setRegisterMap() sets this, and the slave ISR calls it instead of the usual handler while a register map is set.
+static void (*twi_register_handler)(TwoWire *wire_s) = NULL;
+// And setStats() sets this, which is called at the end of each master transaction while stats are kept.
+static void (*twi_stats_handler)(TwoWire *wire_m, uint8_t addr, uint8_t error) = NULL;
+
 
 
 /**
@@ -634,6 +642,11 @@ uint8_t TwoWire::specialConfig( __attribute__ ((unused)) bool smbuslvl, __attrib
 
 
 uint8_t TwoWire::masterReceive(auto *length, uint8_t *buffer, uint8_t addr, uint8_t sendStop) {
+  uint8_t queued = waitForQueue();   // let queued transactions finish first
+  if (queued != TWI_ERR_SUCCESS) {
+    *length = 0;
+    return queued;
+  }
   TWI_t *module = _module;
   __asm__ __volatile__("\n\t" : "+z"(module));
 
@@ -646,6 +659,9 @@ uint8_t TwoWire::masterReceive(auto *length, uint8_t *buffer, uint8_t addr, uint
   #if defined (TWI_TIMEOUT_ENABLE)
     uint16_t timeout = (F_CPU/1000);
   #endif
+  if (_stats != NULL) {
+    _stats->_started = micros();
+  }
 
   while (true) {
     currentStatus = module->MSTATUS;
@@ -707,6 +723,9 @@ uint8_t TwoWire::masterReceive(auto *length, uint8_t *buffer, uint8_t addr, uint
     }
   }
   *length -= dataToRead;
+  if (_stats != NULL) {
+    twi_stats_handler(this, addr, TWIR_GET_ERROR);
+  }
   return TWIR_GET_ERROR;
 }
 
@@ -829,7 +848,12 @@ uint8_t TwoWire::endTransmission(bool sendStop) {
  *@return     uint8_t
  *@retval     errors (see endTransmission)
  */
-uint8_t TwoWire::masterTransmit(auto *length, uint8_t *buffer, uint8_t addr, uint8_t sendStop) {
+uint8_t TwoWire::masterTransmit(auto *length, const uint8_t *buffer, uint8_t addr, uint8_t sendStop) {
+  uint8_t queued = waitForQueue();   // let queued transactions finish first
+  if (queued != TWI_ERR_SUCCESS) {
+    *length = 0;
+    return queued;
+  }
   TWI_t* module = _module;
   __asm__ __volatile__("\n\t" : "+z"(module));
 
@@ -845,6 +869,9 @@ uint8_t TwoWire::masterTransmit(auto *length, uint8_t *buffer, uint8_t addr, uin
   if ((module->MCTRLA & TWI_ENABLE_bm) == 0x00) {  // If the module is disabled, abort
     return TWI_ERR_UNINIT;
   }
+  if (_stats != NULL) {
+    _stats->_started = micros();
+  }
 
   while (true) {
     currentStatus = module->MSTATUS;
@@ -911,9 +938,331 @@ uint8_t TwoWire::masterTransmit(auto *length, uint8_t *buffer, uint8_t addr, uin
   if ((sendStop != 0) || (TWI_ERR_SUCCESS != TWI_GET_ERROR)) {
     module->MCTRLB = TWI_MCMD_STOP_gc;                        // Send STOP
   }
+  if (_stats != NULL) {
+    twi_stats_handler(this, addr, TWI_GET_ERROR);
+  }
   return TWI_GET_ERROR;
 }
 
+/**
+ *@brief      writeTo writes a buffer to a client, straight from the buffer
+ *
+ *            Unlike beginTransmission()/write()/endTransmission(), the data is not copied
+ *            to the Wire buffer first, so the length is not limited by TWI_BUFFER_LENGTH.
+ *
+ *@param      uint8_t address - the address of the client (7-bit)
+ *@param      const uint8_t *buffer - the data to write
+ *@param      size_t length - the number of bytes to write
+ *@param      bool sendStop - if the transaction should be terminated with a STOP condition
+ *
+ *@return     uint8_t
+ *@retval     errors (see endTransmission)
+ */
+uint8_t TwoWire::writeTo(uint8_t address, const uint8_t *buffer, size_t length, bool sendStop) {
+  if (__builtin_constant_p(address)) {
+    if (address > 0x7F) {     // Compile-time check if address is actually 7 bit long
+      badArg("Supplied address seems to be 8 bit. Only 7-bit-addresses are supported");
+      return TWI_ERR_UNDEFINED;
+    }
+  }
+  return masterTransmit(&length, buffer, address << 1, sendStop);
+}
+
+
+/**
+ *@brief      readFrom reads from a client, straight into a buffer
+ *
+ *            Unlike requestFrom()/read(), the data is not copied through the Wire buffer,
+ *            so the length is not limited by TWI_BUFFER_LENGTH.
+ *
+ *@param      uint8_t address - the address of the client (7-bit)
+ *@param      uint8_t *buffer - where to put the data
+ *@param      size_t length - the number of bytes to read. If 0, nothing is done.
+ *@param      bool sendStop - if the transaction should be terminated with a STOP condition
+ *
+ *@return     uint8_t
+ *@retval     errors (see endTransmission)
+ */
+uint8_t TwoWire::readFrom(uint8_t address, uint8_t *buffer, size_t length, bool sendStop) {
+  if (__builtin_constant_p(address)) {
+    if (address > 0x7F) {     // Compile-time check if address is actually 7 bit long
+      badArg("Supplied address seems to be 8 bit. Only 7-bit-addresses are supported");
+      return TWI_ERR_UNDEFINED;
+    }
+  }
+  if (length == 0) {          // masterReceive() would read until the count wrapped around.
+    return TWI_ERR_SUCCESS;
+  }
+  return masterReceive(&length, buffer, address << 1, sendStop);
+}
+
+
+/**
+ *@brief      writeRead writes to a client, then reads from it after a repeated start
+ *
+ *            This is the usual way to read registers: write the register number, then read
+ *            the registers' contents. Both buffers are used in place.
+ *
+ *@param      uint8_t address - the address of the client (7-bit)
+ *@param      const uint8_t *writeBuffer - the data to write, usually the register number
+ *@param      size_t writeLength - the number of bytes to write
+ *@param      uint8_t *readBuffer - where to put the data read
+ *@param      size_t readLength - the number of bytes to read
+ *
+ *@return     uint8_t
+ *@retval     errors (see endTransmission). If the write fails, nothing is read.
+ */
+uint8_t TwoWire::writeRead(uint8_t address, const uint8_t *writeBuffer, size_t writeLength, uint8_t *readBuffer, size_t readLength) {
+  uint8_t error = writeTo(address, writeBuffer, writeLength, readLength == 0);
+  if (error != TWI_ERR_SUCCESS) {
+    return error;
+  }
+  return readFrom(address, readBuffer, readLength, true);
+}
+
+
+/**
+ *@brief      queueTransaction adds a transaction to the end of the master queue
+ *
+ *            If the queue was empty, the transaction is started straight away. It is then
+ *            carried out from the TWI master interrupt, one byte per interrupt, while the
+ *            sketch carries on. When it is done, its status is set to the error code (as
+ *            endTransmission() would return it), the next one is started, and then the
+ *            callback (if any) is called - from the interrupt.
+ *
+ *            Blocking calls (endTransmission(), requestFrom(), etc.) wait for the queue to
+ *            empty before they start, so they must not be made from a callback.
+ *
+ *@param      twiTransaction *transaction - the transaction. It must stay valid until it's done.
+ *
+ *@return     bool
+ *@retval     true if it was queued, false if the master is not enabled, or it is already queued
+ */
+bool TwoWire::queueTransaction(twiTransaction *transaction) {
+  if (_bools._hostEnabled == 0 || transaction->status == TWI_TRANSACTION_PENDING) {
+    return false;
+  }
+  twi_master_handler = HandleMasterIRQ;
+  transaction->status = TWI_TRANSACTION_PENDING;
+  transaction->next   = NULL;
+  uint8_t oldSREG = SREG;
+  cli();
+  twiTransaction *last = _queueHead;
+  if (last == NULL) {
+    _queueHead = transaction;
+    startTransaction();
+  } else {
+    while (last->next != NULL) {
+      last = last->next;
+    }
+    last->next = transaction;
+  }
+  SREG = oldSREG;
+  return true;
+}
+
+
+/**
+ *@brief      waitForQueue waits for queued transactions to finish, before a blocking one starts
+ *
+ *            It gives up on the queue as the blocking transfers give up on the bus: if the
+ *            queue hasn't moved - no byte transferred, no transaction finished - for as long
+ *            as they would wait, it calls abortTransactions(). With interrupts disabled the
+ *            queue can't move at all, so then it doesn't wait.
+ *
+ *@param      void
+ *
+ *@return     uint8_t
+ *@retval     TWI_ERR_SUCCESS if the queue is empty, TWI_ERR_TIMEOUT if it was aborted, or
+ *            TWI_ERR_BUSY if interrupts are disabled and it's not empty (it's left alone).
+ */
+uint8_t TwoWire::waitForQueue(void) {
+  if (_queueHead == NULL) {
+    return TWI_ERR_SUCCESS;
+  }
+  if (!(SREG & CPU_I_bm)) {
+    return TWI_ERR_BUSY;
+  }
+  #if defined(TWI_TIMEOUT_ENABLE)
+    uint16_t timeout = (F_CPU/1000);
+    twiTransaction *head = _queueHead;
+    uint16_t index = *(volatile uint16_t *) &_queueIndex;
+  #endif
+  while (true) {
+    twiTransaction *now = _queueHead;
+    if (now == NULL) {
+      return TWI_ERR_SUCCESS;
+    }
+    #if defined(TWI_TIMEOUT_ENABLE)
+      uint16_t nowIndex = *(volatile uint16_t *) &_queueIndex;  // a torn read only looks like progress, which is harmless
+      if (now != head || nowIndex != index) {
+        head    = now;
+        index   = nowIndex;
+        timeout = (F_CPU/1000);                // reset timeout
+      } else if (--timeout == 0) {
+        abortTransactions();
+        return TWI_ERR_TIMEOUT;
+      }
+    #endif
+  }
+}
+
+
+/**
+ *@brief      abortTransactions stops the transaction on the bus, sends a STOP, and empties the queue
+ *
+ *            Every transaction that was queued gets TWI_ERR_TIMEOUT as its status and its
+ *            callback is called, from here, with interrupts disabled. This is the way out
+ *            if a client holds the clock low: the queue only times out when a blocking
+ *            transfer is waiting for it.
+ *
+ *@param      void
+ *
+ *@return     void
+ */
+void TwoWire::abortTransactions(void) {
+  uint8_t oldSREG = SREG;
+  cli();
+  twiTransaction *transaction = _queueHead;
+  if (transaction != NULL) {
+    TWI_t *module = _module;
+    _queueHead = NULL;
+    module->MCTRLA &= ~(TWI_RIEN_bm | TWI_WIEN_bm);
+    if ((module->MSTATUS & TWI_BUSSTATE_gm) == TWI_BUSSTATE_OWNER_gc) {
+      module->MCTRLB = TWI_MCMD_STOP_gc;
+    }
+    module->MSTATUS = TWI_RIF_bm | TWI_WIF_bm | TWI_ARBLOST_bm | TWI_BUSERR_bm;
+    do {
+      twiTransaction *next = transaction->next;  // the callback may queue it again, which changes next
+      transaction->status = TWI_ERR_TIMEOUT;
+      if (transaction->callback != NULL) {
+        transaction->callback(transaction);
+      }
+      transaction = next;
+    } while (transaction != NULL);
+  }
+  SREG = oldSREG;
+}
+
+
+/**
+ *@brief      startTransaction puts the address of the transaction at the head of the queue on the bus
+ *
+ *            If the bus is held from a transaction without a STOP, this is a repeated start.
+ *            Called with interrupts disabled.
+ *
+ *@param      void
+ *
+ *@return     void
+ */
+void TwoWire::startTransaction(void) {
+  TWI_t *module = _module;
+  twiTransaction *transaction = _queueHead;
+  if (transaction == NULL) {
+    module->MCTRLA &= ~(TWI_RIEN_bm | TWI_WIEN_bm);
+    return;
+  }
+  uint8_t reading = (transaction->writeLength == 0) && (transaction->readLength != 0);
+  _queueReading = reading;
+  _queueIndex   = 0;
+  if (_stats != NULL) {
+    _stats->_started = micros();
+  }
+  module->MCTRLA |= TWI_RIEN_bm | TWI_WIEN_bm;
+  module->MADDR   = (transaction->address << 1) | reading;
+}
+
+
+/**
+ *@brief      finishTransaction takes the transaction at the head of the queue off it, starts the next, and calls the callback
+ *
+ *            The next is started before the callback, so that, if the callback queues another,
+ *            it goes after the ones already waiting. Called with interrupts disabled.
+ *
+ *@param      uint8_t error - the status of the finished transaction
+ *
+ *@return     void
+ */
+void TwoWire::finishTransaction(uint8_t error) {
+  twiTransaction *transaction = _queueHead;
+  _queueHead = transaction->next;
+  transaction->status = error;
+  if (_stats != NULL) {
+    twi_stats_handler(this, transaction->address << 1, error);
+  }
+  startTransaction();
+  if (transaction->callback != NULL) {
+    transaction->callback(transaction);
+  }
+}
+
+
+/**
+ *@brief      HandleMasterIRQ is the state machine for queued transactions, called from the master interrupt
+ *
+ *            WIF is set when the address or a byte has been written (or the address of a
+ *            read was NACKed, or the bus was lost), and RIF when a byte has been read.
+ *
+ *@param      TwoWire *wire_m - the Wire object whose module raised the interrupt
+ *
+ *@return     void
+ */
+void TwoWire::HandleMasterIRQ(TwoWire *wire_m) {
+  TWI_t *module = wire_m->_module;
+  twiTransaction *transaction = wire_m->_queueHead;
+  uint8_t masterStatus = module->MSTATUS;
+
+  if (transaction == NULL) {                  // nothing to do - abortTransactions() got in first
+    module->MCTRLA &= ~(TWI_RIEN_bm | TWI_WIEN_bm);
+    return;
+  }
+
+  uint16_t index = wire_m->_queueIndex;
+  if (masterStatus & (TWI_ARBLOST_bm | TWI_BUSERR_bm)) {
+    // Another master has the bus now, so there's nothing to STOP. Clearing the flags releases the lines.
+    module->MSTATUS = TWI_RIF_bm | TWI_WIF_bm | TWI_ARBLOST_bm | TWI_BUSERR_bm;
+    wire_m->finishTransaction(TWI_ERR_BUS_ARB);
+  } else if (masterStatus & TWI_RIF_bm) {     // A byte was read
+    transaction->readBuffer[index++] = module->MDATA;
+    wire_m->_queueIndex = index;
+    if (index < transaction->readLength) {
+      module->MCTRLB = TWI_MCMD_RECVTRANS_gc;   // ACK it, and read the next
+    } else {
+      if (transaction->sendStop) {
+        module->MCTRLB = TWI_ACKACT_bm | TWI_MCMD_STOP_gc;  // NACK + STOP
+      } else {
+        module->MCTRLB = TWI_ACKACT_bm;         // NACK, and hold the bus for a repeated start
+      }
+      wire_m->finishTransaction(TWI_ERR_SUCCESS);
+    }
+  } else if (masterStatus & TWI_WIF_bm) {
+    if (masterStatus & TWI_RXACK_bm) {        // NACK
+      uint8_t error = TWI_ERR_SUCCESS;        // a NACK of the last byte written is fine
+      if (wire_m->_queueReading || index == 0) {
+        error = TWI_ERR_ACK_ADR;
+      } else if (index < transaction->writeLength) {
+        error = TWI_ERR_ACK_DAT;
+      }
+      module->MCTRLB = TWI_MCMD_STOP_gc;
+      wire_m->finishTransaction(error);
+    } else if (index < transaction->writeLength) {
+      module->MDATA = transaction->writeBuffer[index];
+      wire_m->_queueIndex = index + 1;
+    } else if (transaction->readLength != 0) { // Written, now read: a repeated start with the read bit
+      wire_m->_queueReading = 1;
+      wire_m->_queueIndex   = 0;
+      module->MADDR = ADD_READ_BIT(transaction->address << 1);
+    } else {
+      if (transaction->sendStop) {
+        module->MCTRLB = TWI_MCMD_STOP_gc;
+      }
+      // Otherwise WIF stays set, but the next transaction's address clears it, or there isn't one and the interrupt is turned off.
+      wire_m->finishTransaction(TWI_ERR_SUCCESS);
+    }
+  }
+}
+
+
 /**
  *@brief      write fills the transmit buffers, master or slave, depending on when it is called
  *
@@ -1242,6 +1591,162 @@ uint8_t TwoWire::checkPinLevels(void) {
 }
 
 
+/**
+ *@brief      recoverBus frees a bus that a client is holding SDA low on
+ *
+ *            This happens when the client was in the middle of sending a byte when it
+ *            or the master was reset (a brown-out, for instance); it waits for clocks that
+ *            never come. The master (and the slave, unless it's on its own pins in dual mode)
+ *            is disabled while SCL is clocked up to 9 times, until the client lets go of SDA,
+ *            and a STOP is sent. Then they're put back as they were.
+ *
+ *@param      void
+ *
+ *@return     bool
+ *@retval     true if SDA and SCL are both high afterwards
+ */
+bool TwoWire::recoverBus(void) {
+  TWI_t *module = _module;
+  uint8_t mctrla = module->MCTRLA;
+  uint8_t sctrla = module->SCTRLA;
+  module->MCTRLA = 0;
+  #if defined(TWI_DUALCTRL)
+    if (!(module->DUALCTRL & TWI_ENABLE_bm))
+  #endif
+  {
+    module->SCTRLA = 0;
+  }
+  bool ok;
+  #if defined(TWI1)
+    if (&TWI1 == module) {
+      ok = TWI1_recoverBus();
+    } else
+  #endif
+  {
+    ok = TWI0_recoverBus();
+  }
+  module->SCTRLA = sctrla;
+  module->MCTRLA = mctrla;
+  if (mctrla & TWI_ENABLE_bm) {
+    module->MSTATUS = TWI_BUSSTATE_IDLE_gc;   // Force the state machine into IDLE according to the data sheet
+  }
+  return ok;
+}
+
+
+/**
+ *@brief      scan looks for clients on the bus
+ *
+ *            Each address from first to last is sent, as a write with no data, and the ones
+ *            that are ACKed are listed in found. At 100 kHz each takes about 100 us, so the
+ *            whole range takes around 11 ms; less at a higher clock. The probes are not
+ *            recorded in the setStats() statistics, where every empty address would be a NACK.
+ *
+ *@param      uint8_t *found - where to put the addresses found (can be NULL to just count them)
+ *@param      uint8_t maxFound - how many addresses found can hold. More are counted, not listed.
+ *@param      uint8_t first, last - the range of addresses to try. The default skips the reserved ones.
+ *
+ *@return     uint8_t
+ *@retval     the number of clients found, or TWI_SCAN_BUS_ERROR if the bus failed and the scan stopped.
+ */
+uint8_t TwoWire::scan(uint8_t *found, uint8_t maxFound, uint8_t first, uint8_t last) {
+  uint8_t count = 0;
+  uint8_t oldSREG = SREG;
+  cli();
+  twiStats *stats = _stats;                 // the ISR reads it too, so swap it with interrupts off
+  _stats = NULL;
+  SREG = oldSREG;
+  for (uint8_t address = first; address <= last && address < 0x80; address++) {
+    twi_buf_index_t length = 0;
+    uint8_t error = masterTransmit(&length, NULL, address << 1, 1);
+    if (error == TWI_ERR_SUCCESS) {
+      if (found != NULL && count < maxFound) {
+        found[count] = address;
+      }
+      count++;
+    } else if (error != TWI_ERR_ACK_ADR) {
+      count = TWI_SCAN_BUS_ERROR;
+      break;
+    }
+  }
+  cli();
+  _stats = stats;
+  SREG = oldSREG;
+  return count;
+}
+
+
+/**
+ *@brief      setStats starts or stops keeping bus health statistics
+ *
+ *            From now on, every master transaction is recorded in stats: how long it took,
+ *            and whether it was NACKed, timed out, or lost arbitration, and, if stats has a
+ *            perAddress array, which client it was for. If stats->autoRecover is set, a
+ *            timeout or stuck bus is followed by recoverBus().
+ *
+ *@param      twiStats *stats - where to keep the statistics, or NULL to stop.
+ *
+ *@return     void
+ */
+void TwoWire::setStats(twiStats *stats) {
+  twi_stats_handler = RecordStats;
+  _stats = stats;
+}
+
+
+/**
+ *@brief      RecordStats adds a finished master transaction to the statistics
+ *
+ *@param      TwoWire *wire_m - the Wire object
+ *@param      uint8_t addr - the address of the client, left-shifted
+ *@param      uint8_t error - how it ended
+ *
+ *@return     void
+ */
+void TwoWire::RecordStats(TwoWire *wire_m, uint8_t addr, uint8_t error) {
+  twiStats *stats = wire_m->_stats;
+  uint32_t elapsed = micros() - stats->_started;
+  stats->transactions++;
+  stats->busyMicros += elapsed;
+  uint8_t bin = 0;
+  elapsed >>= 6;
+  while (elapsed != 0 && bin < TWI_STATS_BINS - 1) {
+    elapsed >>= 1;
+    bin++;
+  }
+  stats->latency[bin]++;
+  if (error == TWI_ERR_SUCCESS) {
+    return;
+  }
+  twiAddressStats *perAddress = stats->perAddress;
+  if (perAddress != NULL) {
+    perAddress += (addr >> 1);
+  }
+  if (error == TWI_ERR_ACK_ADR || error == TWI_ERR_ACK_DAT) {
+    stats->nacks++;
+    if (perAddress != NULL) {
+      perAddress->nacks++;
+    }
+  } else if (error == TWI_ERR_BUS_ARB) {
+    stats->arbLost++;
+    if (perAddress != NULL) {
+      perAddress->arbLost++;
+    }
+  } else if (error == TWI_ERR_TIMEOUT || error == TWI_ERR_PULLUP || error == TWI_ERR_CLKHLD) {
+    stats->timeouts++;
+    if (perAddress != NULL) {
+      perAddress->timeouts++;
+    }
+    if (stats->autoRecover) {
+      stats->recoveries++;
+      wire_m->recoverBus();
+    }
+  } else {
+    stats->otherErrors++;
+  }
+}
+
+
 /**
  *@brief      selectSlaveBuffer allows the user to access the slave buffer
  *
@@ -1293,6 +1798,10 @@ void TwoWire::HandleSlaveIRQ(TwoWire *wire_s) {
   if (wire_s == NULL) {
     return;
   }
+  if (wire_s->_regMap != NULL) {
+    twi_register_handler(wire_s);
+    return;
+  }
 
 
   uint8_t *address,  *buffer;
@@ -1390,6 +1899,115 @@ void TwoWire::HandleSlaveIRQ(TwoWire *wire_s) {
 
 
 
+/**
+ *@brief      setRegisterMap makes the client act like a typical I2C device with registers, without the handlers
+ *
+ *            The first byte of a host WRITE sets the register pointer, and any further bytes
+ *            are written to the registers, from there on. A host READ reads the registers,
+ *            from the pointer on. Either way, the pointer is incremented after each byte, and
+ *            goes back to 0 after the last register. A pointer past the last register is 0 too.
+ *            This is all done in the slave interrupt, straight to and from the registers, so
+ *            onReceive() and onRequest() handlers are not called.
+ *
+ *            Bits that are 0 in writeMask can't be written by the host; a register whose mask
+ *            is 0 is read only. Registers the sketch changes while the host might be reading
+ *            them - a multi-byte value, for instance - should be changed with interrupts off.
+ *
+ *@param      volatile uint8_t *registers - the registers, or NULL to go back to the handlers
+ *@param      uint16_t size - how many registers there are, 1 to 256
+ *@param      const uint8_t *writeMask - an array of size masks, or NULL if every bit can be written
+ *
+ *@return     void
+ */
+void TwoWire::setRegisterMap(volatile uint8_t *registers, uint16_t size, const uint8_t *writeMask) {
+  if (__builtin_constant_p(size)) {
+    if (size > 256) {
+      badArg("A register map can have at most 256 registers, as the pointer is one byte");
+    }
+  }
+  if (size > 256) {
+    size = 256;
+  }
+  twi_register_handler = HandleRegisterIRQ;
+  uint8_t oldSREG = SREG;
+  cli();
+  _regMask    = writeMask;
+  _regLast    = size - 1;
+  _regPointer = 0;
+  _regState   = 0;
+  _regMap     = (size == 0) ? NULL : registers;
+  SREG = oldSREG;
+}
+
+
+/**
+ *@brief      HandleRegisterIRQ is the slave interrupt handler used while a register map is set
+ *
+ *@param      TwoWire *wire_s - the Wire object whose module raised the interrupt
+ *
+ *@return     void
+ */
+void TwoWire::HandleRegisterIRQ(TwoWire *wire_s) {
+  TWI_t *module = wire_s->_module;
+  uint8_t action = 0;
+  uint8_t state = wire_s->_regState;                // bit 0: transaction open, bit 1: next byte written sets the pointer
+  uint8_t clientStatus = module->SSTATUS;
+
+  if (clientStatus & TWI_APIF_bm) {                 // Address/Stop Bit set
+    if (clientStatus & TWI_AP_bm) {                 // Address bit set: START or REPSTART
+      if (state == 0) {                               // only if there was no transaction (START)
+        pauseDeepSleep((uint8_t)((uint16_t)module));  // Only START can wake from deep sleep, change to IDLE
+      }
+      #if defined(TWI_MANDS)
+        wire_s->_incomingAddress = module->SDATA;     // read address from data register
+      #else
+        wire_s->_clientAddress   = module->SDATA;
+      #endif
+      if (clientStatus & TWI_DIR_bm) {                // Master is reading
+        wire_s->client_irq_mask = TWI_COLL_bm;        // the first DIF follows the address, so its RXACK doesn't matter
+        state = 0x01;
+      } else {                                        // Master is writing, the first byte is the pointer
+        state = 0x03;
+      }
+      action = TWI_SCMD_RESPONSE_gc;
+    } else {                                        // Stop bit set
+      restoreSleep((uint8_t)((uint16_t)module));
+      state  = 0;
+      action = TWI_SCMD_COMPTRANS_gc;                 // "Wait for any Start (S/Sr) condition"
+    }
+  } else if (clientStatus & TWI_DIF_bm) {           // Data bit set
+    volatile uint8_t *reg = wire_s->_regMap;
+    uint8_t pointer = wire_s->_regPointer;
+    if (clientStatus & TWI_DIR_bm) {                // Master is reading
+      if (clientStatus & wire_s->client_irq_mask) { // NACK (the master is done) or collision
+        wire_s->client_irq_mask = TWI_COLL_bm;
+        action = TWI_SCMD_COMPTRANS_gc;
+      } else {
+        wire_s->_bytesTransmittedS++;
+        wire_s->client_irq_mask = TWI_COLL_bm | TWI_RXACK_bm;  // start checking for NACK
+        module->SDATA = reg[pointer];
+        pointer = (pointer == wire_s->_regLast) ? 0 : pointer + 1;
+        action = TWI_SCMD_RESPONSE_gc;
+      }
+    } else {                                        // Master is writing
+      uint8_t payload = module->SDATA;
+      if (state & 0x02) {
+        state   = 0x01;
+        pointer = (payload > wire_s->_regLast) ? 0 : payload;
+      } else {
+        uint8_t mask = (wire_s->_regMask == NULL) ? 0xFF : wire_s->_regMask[pointer];
+        reg[pointer] = (payload & mask) | (reg[pointer] & ~mask);
+        pointer = (pointer == wire_s->_regLast) ? 0 : pointer + 1;
+      }
+      action = TWI_SCMD_RESPONSE_gc;
+    }
+    wire_s->_regPointer = pointer;
+  }
+  wire_s->_regState = state;
+  module->SCTRLB = action;
+}
+
+
 /**
  *@brief      onReceive saves the pointer to the desired function to call on host WRITE / client READ.
  *
@@ -1436,6 +2054,28 @@ ISR(TWI0_TWIS_vect) {
 #endif
 
 
+/**
+ *@brief      TWI0 Master Interrupt vector, only enabled while transactions are queued
+ */
+ISR(TWI0_TWIM_vect) {
+  if (twi_master_handler != NULL) {
+    twi_master_handler(twi0_wire);
+  }
+}
+
+
+/**
+ *@brief      TWI1 Master Interrupt vector
+ */
+#if defined(TWI1)
+  ISR(TWI1_TWIM_vect) {
+    if (twi_master_handler != NULL) {
+      twi_master_handler(twi1_wire);
+    }
+  }
+#endif
+
+
 /**
  *@brief      pauseDeepSleep and restoreSleep handle the sleep guard
  *
@@ -151,6 +151,7 @@
   #define  TWI_ERR_BUS_ARB       0x12  // Bus error and/or Arbitration lost
   #define  TWI_ERR_BUF_OVERFLOW  0x13  // Buffer overflow on master read
   #define  TWI_ERR_CLKHLD        0x14  // Something's holding the clock
+  #define  TWI_ERR_BUSY          0x15  // Transactions are queued, and with interrupts disabled, they can't finish
 #else
   // DISABLE_NEW_ERRORS can be used to more completely emulate the old error reporting behavior; this should rarely be needed.
   #define  TWI_ERR_UNINIT        TWI_ERR_UNDEFINED  // TWI was in bad state when method was called.
@@ -158,6 +159,7 @@
   #define  TWI_ERR_BUS_ARB       TWI_ERR_UNDEFINED  // Bus error and/or Arbitration lost
   #define  TWI_ERR_BUF_OVERFLOW  TWI_ERR_UNDEFINED  // Buffer overflow on master read
   #define  TWI_ERR_CLKHLD        TWI_ERR_UNDEFINED  // Something's holding the clock
+  #define  TWI_ERR_BUSY          TWI_ERR_UNDEFINED  // Transactions are queued, and with interrupts disabled, they can't finish
 #endif
 
 #if defined(TWI_ERROR_ENABLED)
@@ -202,8 +204,58 @@ struct twiDataBools {         // using a struct so the compiler can use skip if
 };
 
 
+/* A master transaction for queueTransaction(), which is carried out from the TWI master interrupt while the sketch keeps
+ * running. The write part, if any, is sent first, then, if readLength is not 0, a repeated start and the read. With neither,
+ * it only checks that the address is ACKed. The buffers are used in place, so they - and the transaction itself - must stay
+ * valid until it is done; there is no limit on the length from TWI_BUFFER_LENGTH.
+ */
+#define  TWI_TRANSACTION_PENDING 0xFE  // status while a transaction is in the queue or on the bus
+
+struct twiTransaction;
+typedef void (*twiTransactionCallback)(twiTransaction *transaction);
+
+struct twiTransaction {
+  uint8_t                 address     = 0;       // 7-bit client address
+  bool                    sendStop    = true;    // false to hold the bus, so the next transaction begins with a repeated start
+  const uint8_t          *writeBuffer = NULL;
+  uint16_t                writeLength = 0;
+  uint8_t                *readBuffer  = NULL;
+  uint16_t                readLength  = 0;
+  twiTransactionCallback  callback    = NULL;    // called from the interrupt when it's done. It may queue it again.
+  volatile uint8_t        status      = TWI_ERR_SUCCESS;  // TWI_TRANSACTION_PENDING until done, then an error code
+  twiTransaction         *next        = NULL;    // used by the queue
+};
+
+
+
 
 
+/* Bus health statistics, for setStats(). Every master transaction - blocking or queued - is counted, with how long it took
+ * and how it ended. The sketch owns this; it can read it, or clear it, whenever it likes.
+ */
+#define  TWI_STATS_BINS      8     // latency[n] counts transactions that took under (64 << n) us; the last bin, all longer ones.
+#define  TWI_SCAN_BUS_ERROR  0xFF  // returned by scan() if the bus failed, rather than just getting no ACK
+
+struct twiAddressStats {
+  uint16_t nacks;                  // address or data NACKed
+  uint16_t timeouts;               // timed out, bus stuck, or clock held low
+  uint16_t arbLost;                // arbitration lost or bus error
+};
+
+struct twiStats {
+  uint32_t transactions   = 0;
+  uint32_t busyMicros     = 0;     // total time spent on transactions, to compare with micros() for the bus utilization
+  uint16_t nacks          = 0;
+  uint16_t timeouts       = 0;
+  uint16_t arbLost        = 0;
+  uint16_t otherErrors    = 0;
+  uint16_t recoveries     = 0;     // recoverBus() calls made because of autoRecover
+  uint16_t latency[TWI_STATS_BINS] = {0};
+  twiAddressStats *perAddress = NULL;  // optional: an array of 128, indexed by address, to see which client had trouble
+  bool     autoRecover    = false; // call recoverBus() after a timeout or stuck bus
+  uint32_t _started;               // used by the library
+};
+
 
 class TwoWire: public Stream {
   private:
@@ -230,6 +282,22 @@ class TwoWire: public Stream {
     twi_buf_index_t _bytesReadWrittenS;
     #endif
 
+    twiTransaction * volatile _queueHead = NULL;  // the transaction on the bus, followed by the rest of the queue
+    uint16_t _queueIndex;                           // bytes of it written or read so far
+    uint8_t  _queueReading;                         // 1 once it's in the read part
+
+    volatile uint8_t *_regMap = NULL;               // register map mode: the registers,
+    const uint8_t *_regMask;                        // which bits of each can be written (NULL for all),
+    uint8_t  _regLast;                              // the number of the last register,
+    uint8_t  _regPointer;                           // the register pointer,
+    uint8_t  _regState;                             // and whether a transaction is open, and the next byte sets the pointer
+
+    twiStats *_stats = NULL;
+
+    void startTransaction(void);
+    void finishTransaction(uint8_t error);
+    uint8_t waitForQueue(void);
+
     uint8_t _hostBuffer[TWI_BUFFER_LENGTH];
     #if defined(TWI_MANDS)
     uint8_t _clientBuffer[TWI_BUFFER_LENGTH];
@@ -261,9 +329,19 @@ class TwoWire: public Stream {
 
     twi_buf_index_t requestFrom(uint8_t address, twi_buf_index_t quantity, uint8_t sendStop = 1);
 
-    uint8_t masterTransmit(auto *length, uint8_t *buffer, uint8_t addr, uint8_t sendStop);
+    uint8_t masterTransmit(auto *length, const uint8_t *buffer, uint8_t addr, uint8_t sendStop);
     uint8_t masterReceive(auto *length, uint8_t *buffer, uint8_t addr, uint8_t sendStop);
 
+    uint8_t writeTo(uint8_t address, const uint8_t *buffer, size_t length, bool sendStop = true);
+    uint8_t readFrom(uint8_t address, uint8_t *buffer, size_t length, bool sendStop = true);
+    uint8_t writeRead(uint8_t address, const uint8_t *writeBuffer, size_t writeLength, uint8_t *readBuffer, size_t readLength);
+
+    bool    queueTransaction(twiTransaction *transaction);
+    bool    transactionsPending(void) {
+      return _queueHead != NULL;
+    }
+    void    abortTransactions(void);
+
     virtual size_t write(uint8_t);
     virtual size_t write(const uint8_t *, size_t);
     virtual int available(void);
@@ -275,11 +353,16 @@ class TwoWire: public Stream {
     twi_buf_index_t getBytesRead(void);
     uint8_t slaveTransactionOpen(void);
     uint8_t checkPinLevels(void);             // Can be used to make sure after boot that SDA/SCL are high
+    bool    recoverBus(void);                 // Clocks SCL until SDA is released, then sends a STOP
+    uint8_t scan(uint8_t *found, uint8_t maxFound, uint8_t first = 0x08, uint8_t last = 0x77);
+    void    setStats(twiStats *stats);
     void    enableDualMode(bool fmp_enable);  // Moves the Slave to dedicated pins
 
     void selectSlaveBuffer();
     void deselectSlaveBuffer();
 
+    void setRegisterMap(volatile uint8_t *registers, uint16_t size, const uint8_t *writeMask = NULL);
+
     void onReceive(void (*)(int));
     void onRequest(void (*)(void));
 
@@ -304,6 +387,9 @@ class TwoWire: public Stream {
     size_t readBytes(char *data, size_t quantity);
 
     static void HandleSlaveIRQ(TwoWire *wire_s);
+    static void HandleRegisterIRQ(TwoWire *wire_s);
+    static void RecordStats(TwoWire *wire_m, uint8_t addr, uint8_t error);
+    static void HandleMasterIRQ(TwoWire *wire_m);
 };
 
 
@@ -515,6 +515,78 @@ uint8_t TWI0_checkPinLevel(void) {
   #endif
 }
 
+/* Free a bus that a client is holding SDA low on - typically because it was reset (or we were) partway through sending a
+ * byte, and it's waiting for the rest of the clocks. We clock SCL until the client lets go of SDA (at most 9 clocks - 8 data
+ * bits and the ACK), then send a STOP, so it forgets the transfer. The TWI master must be disabled, so that the port controls
+ * the pins. Like the TWI, we only ever drive them low - OUT stays 0, and DIR drives or releases them. Returns true if both
+ * lines are high afterwards.
+ */
+static bool TWI_recoverPins(PORT_t *port, uint8_t sda_bm, uint8_t scl_bm) {
+  port->OUTCLR = sda_bm | scl_bm;
+  port->DIRCLR = sda_bm | scl_bm;
+  delayMicroseconds(5);
+  for (uint8_t i = 0; i < 9 && !(port->IN & sda_bm); i++) {
+    port->DIRSET = scl_bm;
+    delayMicroseconds(5);
+    port->DIRCLR = scl_bm;
+    delayMicroseconds(5);
+  }
+  port->DIRSET = scl_bm;                  // STOP: SDA low while SCL is low,
+  delayMicroseconds(5);
+  port->DIRSET = sda_bm;
+  delayMicroseconds(5);
+  port->DIRCLR = scl_bm;                  // then SCL high,
+  delayMicroseconds(5);
+  port->DIRCLR = sda_bm;                  // then SDA high.
+  delayMicroseconds(5);
+  return (port->IN & (sda_bm | scl_bm)) == (sda_bm | scl_bm);
+}
+
+// Uses the same pins as TWI0_checkPinLevel()
+bool TWI0_recoverBus(void) {
+  #if defined(PORTMUX_TWIROUTEA)     /* Dx-series */
+    uint8_t portmux = (PORTMUX.TWIROUTEA & PORTMUX_TWI0_gm);
+    PORT_t *port;
+    #if defined(__AVR_DU__)
+      port = &PORTA;
+    #else
+      if (portmux == PORTMUX_TWI0_ALT2_gc) {
+        port = &PORTC;
+      } else {
+        port = &PORTA;
+      }
+    #endif
+    #if !defined(__AVR_DA__) && !defined(__AVR_DB__) //DD and EA, and presumably later parts, have an extra mux option.
+      if (portmux == 3) {
+        return TWI_recoverPins(port, 0x01, 0x02);
+      }
+    #endif
+    return TWI_recoverPins(port, 0x04, 0x08);
+  #elif defined(PORTMUX_TWISPIROUTEA)
+    uint8_t portmux = (PORTMUX.TWISPIROUTEA & PORTMUX_TWI0_gm);
+    if (portmux == PORTMUX_TWI0_ALT2_gc) {
+      return TWI_recoverPins(&PORTC, 0x04, 0x08);
+    } else {
+      return TWI_recoverPins(&PORTA, 0x04, 0x08);
+    }
+  #elif defined(MEGATINYCORE)  /* tinyAVR 0/1-series */
+    #if defined(PORTMUX_TWI0_bm)  // Has a pin multiplexer
+      if (PORTMUX.CTRLB & PORTMUX_TWI0_bm) {
+        return TWI_recoverPins(&PORTA, 0x02, 0x04);
+      } else {
+        return TWI_recoverPins(&PORTB, 0x02, 0x01);
+      }
+    #elif defined(__AVR_ATtinyxy2__)  // No PORTMUX for 8-pin parts, they always use PA1/2
+      return TWI_recoverPins(&PORTA, 0x02, 0x04);
+    #else //it uses PB0/1
+      return TWI_recoverPins(&PORTB, 0x02, 0x01);
+    #endif
+  #else
+    #error "Only modern AVR parts are supported by this version of Wire: tinyAVR 0/1/2-series, megaAVR 0-series, AVR Dx-series or AVR Ex-series."
+    return false;
+  #endif
+}
+
 #if defined(TWI0_DUALCTRL) // full version for parts with dual mode and likely input level too
   uint8_t TWI0_setConfig(bool smbuslvl, bool longsetup, uint8_t sda_hold, bool smbuslvl_dual, uint8_t sda_hold_dual) {
     uint8_t cfg = TWI0.CTRLA & 0x03;
@@ -722,6 +794,16 @@ uint8_t TWI1_checkPinLevel(void) {
   #endif
 }
 
+// Uses the same pins as TWI1_checkPinLevel()
+bool TWI1_recoverBus(void) {
+  #if defined(PORTB)
+    if ((PORTMUX.TWIROUTEA & PORTMUX_TWI1_gm) == PORTMUX_TWI1_ALT2_gc) {
+      return TWI_recoverPins(&PORTB, 0x04, 0x08);
+    }
+  #endif
+  return TWI_recoverPins(&PORTF, 0x04, 0x08);
+}
+
 // All devices with TWI1 have dual mode and the most have the smbus levels; the exceptions are caught before this is called
 uint8_t TWI1_setConfig(bool smbuslvl, bool longsetup, uint8_t sda_hold, bool smbuslvl_dual, uint8_t sda_hold_dual) {
   uint8_t cfg = TWI1.CTRLA & 0x03;
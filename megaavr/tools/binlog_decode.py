@@ -0,0 +1,186 @@
+#!/usr/bin/python3
+
+# -*- coding: utf-8 -*-
+# binlog_decode.py - turns the output of the BinaryLog library back into text.
+#
+# The chip sends the flash address of each format string, followed by the raw arguments; we look the format string up in the
+# .elf that the sketch was built as, work out from it how many bytes each argument takes, and format it here. See
+# libraries/BinaryLog/src/BinaryLog.h for the record format. Anything between records (ordinary Serial.print() output, say)
+# is passed through unchanged.
+#
+# Usage:
+#   binlog_decode.py sketch.ino.elf -p /dev/ttyUSB0 [-b 115200]   read from a serial port until ctrl-c
+#   binlog_decode.py sketch.ino.elf -f capture.bin                 decode a file captured some other way
+import sys
+import os
+import re
+import struct
+import argparse
+
+# dependencies
+toolspath = os.path.dirname(os.path.realpath(__file__))
+sys.path.insert(0, os.path.join(toolspath, "libs"))
+
+MARKER = 0x1E
+FLASH_END = 0x800000  # addresses at or above this are RAM (0x800000) or EEPROM etc in avr-gcc .elf files
+
+# printf conversion: flags, width, precision, length, conversion
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l)?([diouxXcsSpfeEgG%])")
+
+
+class ElfFlash:
+    """The contents of flash, as described by the allocated sections of an avr-gcc .elf"""
+
+    def __init__(self, filename):
+        with open(filename, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError(filename + " is not a 32-bit little endian ELF file")
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+        self.regions = []
+        for i in range(shnum):
+            (name, sh_type, flags, addr, offset, size) = struct.unpack_from("<IIIIII", data, shoff + i * shentsize)
+            # SHT_PROGBITS with SHF_ALLOC, in the flash address space.
+            if sh_type == 1 and (flags & 2) and addr < FLASH_END and size:
+                self.regions.append((addr, data[offset:offset + size]))
+
+    def string(self, address):
+        for (start, contents) in self.regions:
+            if start <= address < start + len(contents):
+                end = contents.find(b"\0", address - start)
+                if end < 0:
+                    end = len(contents)
+                return contents[address - start:end].decode("latin-1")
+        return None
+
+
+def take(args, count):
+    if len(args) < count:
+        raise IndexError
+    return args[:count], args[count:]
+
+
+def decode_record(flash, address, args):
+    fmt = flash.string(address)
+    if fmt is None:
+        return "<BinaryLog: no format string at 0x%04X>" % address
+    out = []
+    pos = 0
+    try:
+        for m in CONVERSION.finditer(fmt):
+            out.append(fmt[pos:m.start()])
+            pos = m.end()
+            flags, width, precision, length, conv = m.groups()
+            if conv == "%":
+                out.append("%")
+                continue
+            # * width and precision are passed as int arguments, before the value.
+            if width == "*":
+                raw, args = take(args, 2)
+                width = str(struct.unpack("<h", raw)[0])
+            if precision == "*":
+                raw, args = take(args, 2)
+                precision = str(struct.unpack("<h", raw)[0])
+            spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+            if conv in "di":
+                size = {"ll": 8, "l": 4}.get(length, 2)
+                raw, args = take(args, size)
+                value = int.from_bytes(raw, "little", signed=True)
+                if length == "hh":
+                    value = struct.unpack("<b", raw[:1])[0]
+                out.append((spec + "d") % value)
+            elif conv in "ouxX":
+                size = {"ll": 8, "l": 4}.get(length, 2)
+                raw, args = take(args, size)
+                value = int.from_bytes(raw, "little")
+                if length == "hh":
+                    value &= 0xFF
+                out.append((spec + ("d" if conv == "u" else conv)) % value)
+            elif conv == "c":
+                raw, args = take(args, 2)
+                out.append((spec + "c") % raw[0])
+            elif conv == "s":
+                end = args.find(b"\0")
+                if end < 0:
+                    raise IndexError
+                out.append((spec + "s") % args[:end].decode("latin-1"))
+                args = args[end + 1:]
+            elif conv == "S":
+                raw, args = take(args, 2)
+                s = flash.string(struct.unpack("<H", raw)[0])
+                out.append((spec + "s") % (s if s is not None else "<?>"))
+            elif conv == "p":
+                raw, args = take(args, 2)
+                out.append("0x%04x" % struct.unpack("<H", raw)[0])
+            else:  # f, e, g - double is 4 bytes on AVR
+                raw, args = take(args, 4)
+                out.append((spec + conv) % struct.unpack("<f", raw)[0])
+    except IndexError:
+        out.append("<truncated>")
+        return "".join(out)
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+class Decoder:
+    """Feed it bytes, it returns text - decoded records, plus anything that wasn't a record."""
+
+    def __init__(self, flash):
+        self.flash = flash
+        self.pending = bytearray()
+
+    def feed(self, data):
+        self.pending += data
+        out = []
+        while self.pending:
+            start = self.pending.find(bytes([MARKER]))
+            if start < 0:
+                out.append(self.pending.decode("latin-1"))
+                self.pending = bytearray()
+                break
+            if start:
+                out.append(self.pending[:start].decode("latin-1"))
+                del self.pending[:start]
+            if len(self.pending) < 2 or len(self.pending) < self.pending[1] + 2:
+                break  # wait for the rest of it
+            length = self.pending[1]
+            record = bytes(self.pending[2:2 + length])
+            del self.pending[:2 + length]
+            if length < 2:
+                out.append("<BinaryLog: bad record>\n")
+                continue
+            address = record[0] | (record[1] << 8)
+            out.append(decode_record(self.flash, address, record[2:]))
+        return "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the output of the BinaryLog library")
+    parser.add_argument("elf", help="The .elf file the sketch was built as (Sketch -> Export compiled binary puts it in the sketch folder)")
+    parser.add_argument("-p", "--port", help="Serial port to read from")
+    parser.add_argument("-b", "--baudrate", type=int, default=115200, help="Baud rate (default: 115200)")
+    parser.add_argument("-f", "--file", help="Read from this file instead of a serial port")
+    args = parser.parse_args()
+
+    decoder = Decoder(ElfFlash(args.elf))
+    if args.file:
+        with open(args.file, "rb") as f:
+            sys.stdout.write(decoder.feed(f.read()))
+        return
+    if not args.port:
+        parser.error("either --port or --file is required")
+    import serial
+    with serial.Serial(args.port, args.baudrate, timeout=0.1) as port:
+        try:
+            while True:
+                data = port.read(256)
+                if data:
+                    sys.stdout.write(decoder.feed(data))
+                    sys.stdout.flush()
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()